@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <thread>
+#include "../../Common/ContainerStats.h"
+#include "../Vector.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct CountingAllocatorTest {
+    CountingAllocatorTest() {
+        using container_stats::CountingAllocator;
+        container_stats::Stats before = container_stats::current();
+
+        {
+            // Capacity doubles from 8, so 100 elements take five buffers
+            Vector<int, CountingAllocator<int>> vec;
+            for (int i = 0; i < 100; ++i) {
+                vec.push_back(i);
+            }
+
+            const container_stats::Stats& stats = container_stats::current();
+            assertEqual(stats.allocations - before.allocations, 5u, __LINE__,
+                        __FILE__);
+            assertEqual(stats.deallocations - before.deallocations, 4u,
+                        __LINE__, __FILE__);
+            assertEqual(stats.bytes - before.bytes,
+                        (8 + 16 + 32 + 64 + 128) * sizeof(int), __LINE__,
+                        __FILE__);
+            assertEqual(stats.live_blocks - before.live_blocks, 1, __LINE__,
+                        __FILE__);
+        }
+
+        const container_stats::Stats& stats = container_stats::current();
+        assertEqual(stats.allocations - before.allocations,
+                    stats.deallocations - before.deallocations, __LINE__,
+                    __FILE__);
+        assertEqual(stats.live_blocks, before.live_blocks, __LINE__, __FILE__);
+
+        // A block freed on another thread than the one that allocated it
+        // leaves the freeing thread below zero, and only the sum over all
+        // threads comes out even
+        container_stats::Stats total_before = container_stats::total();
+        auto* handed_over = new Vector<int, CountingAllocator<int>>();
+        handed_over->push_back(1);
+
+        std::ptrdiff_t worker_live = 0;
+        std::thread worker([&] {
+            delete handed_over;
+            worker_live = container_stats::current().live_blocks;
+        });
+        worker.join();
+        assertEqual(worker_live, -1, __LINE__, __FILE__);
+
+        container_stats::Stats total_after = container_stats::total();
+        assertEqual(total_after.allocations - total_before.allocations, 1u,
+                    __LINE__, __FILE__);
+        assertEqual(total_after.deallocations - total_before.deallocations,
+                    1u, __LINE__, __FILE__);
+        assertEqual(total_after.live_blocks, total_before.live_blocks,
+                    __LINE__, __FILE__);
+    }
+};
+
+static CountingAllocatorTest countingAllocatorTest;
+}  // namespace test
@@ -19,6 +19,7 @@
 #include "Tests/14ClassWithoutDefaultConstructorTest.h"
 #include "Tests/15ClassWithoutCopyConstructorTest.h"
 #include "Tests/16MoveConstructorAndMoveAssignmentOperatorTest.h"
+#include "Tests/17CountingAllocatorTest.h"
 
 auto main() -> int {
     std::cout << "All tests have passed :3\n";
@@ -1,9 +1,16 @@
 #pragma once
 #include <algorithm>
+#include <memory>
 #include <ostream>
+#include <type_traits>
 #include <utility>
 
-template <typename T>
+#include "../Common/NodeAllocators.h"
+
+// Nodes come from `A`, rebound to the node type, so a NodePool or an Arena
+// (see Common/NodeAllocators.h) can stand in for a heap allocation apiece.
+
+template <typename T, typename A = std::allocator<T>>
 class ForwardList {
     struct NodeHeader {
         NodeHeader* next;
@@ -16,25 +23,48 @@ class ForwardList {
         Node(NodeHeader* next, Args&&... args);
     };
 
+    using NodeAlloc =
+        typename std::allocator_traits<A>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    // Whether move assignment can always take the other list's nodes
+    static constexpr bool moves_nodes =
+        NodeTraits::propagate_on_container_move_assignment::value ||
+        NodeTraits::is_always_equal::value;
+
     NodeHeader root = NodeHeader(nullptr);
+    [[no_unique_address]]
+    NodeAlloc alloc;
+
+    template <typename... Args>
+    auto new_node(NodeHeader* next, Args&&... args) -> Node*;
+    auto delete_node(NodeHeader* node) -> void;
+    auto delete_nodes() -> void;
 
   public:
+    using allocator_type = A;
+
     ForwardList();
+    explicit ForwardList(const A& alloc);
     template <typename... Args>
         requires requires(Args... args) { T(std::forward<Args>(args)...); }
     explicit ForwardList(std::size_t n, Args&&... args);
 
     template <std::input_iterator It, std::sentinel_for<It> Sn>
         requires std::constructible_from<std::iter_value_t<It>, T>
-    ForwardList(It begin, Sn end);
-    ForwardList(std::initializer_list<T> list);
+    ForwardList(It begin, Sn end, const A& alloc = A());
+    ForwardList(std::initializer_list<T> list, const A& alloc = A());
 
     ForwardList(const ForwardList& other);
+    ForwardList(ForwardList&& other) noexcept;
     auto operator=(const ForwardList& other) -> ForwardList&;
+    auto operator=(ForwardList&& other) noexcept(moves_nodes) -> ForwardList&;
     ~ForwardList();
 
+    auto get_allocator() const -> A;
+
     class iterator {
-        friend class ForwardList<T>;
+        friend class ForwardList;
         NodeHeader* node;
 
         explicit iterator(NodeHeader* node);
@@ -55,7 +85,7 @@ class ForwardList {
     static_assert(std::output_iterator<iterator, T>);
 
     class const_iterator {
-        friend class ForwardList<T>;
+        friend class ForwardList;
         const NodeHeader* node;
 
         explicit const_iterator(NodeHeader* node);
@@ -104,52 +134,107 @@ class ForwardList {
     auto operator==(const ForwardList& other) const -> bool;
 };
 
-template <typename T>
-ForwardList<T>::NodeHeader::NodeHeader(NodeHeader* next) : next(next) {}
+template <typename T, typename A>
+ForwardList<T, A>::NodeHeader::NodeHeader(NodeHeader* next) : next(next) {}
 
-template <typename T>
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-ForwardList<T>::Node::Node(NodeHeader* next, Args&&... args)
+ForwardList<T, A>::Node::Node(NodeHeader* next, Args&&... args)
     : NodeHeader(next), data(std::forward<Args>(args)...) {}
 
-template <typename T>
-ForwardList<T>::ForwardList() = default;
+template <typename T, typename A>
+template <typename... Args>
+auto ForwardList<T, A>::new_node(NodeHeader* next, Args&&... args) -> Node* {
+    Node* node = NodeTraits::allocate(alloc, 1);
+    try {
+        NodeTraits::construct(alloc, node, next, std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template <typename T, typename A>
+auto ForwardList<T, A>::delete_node(NodeHeader* node) -> void {
+    Node* full_node = static_cast<Node*>(node);
+    NodeTraits::destroy(alloc, full_node);
+    NodeTraits::deallocate(alloc, full_node, 1);
+}
+
+// With nothing to destroy in an arena that frees nothing one by one,
+// the nodes don't even need visiting
+template <typename T, typename A>
+auto ForwardList<T, A>::delete_nodes() -> void {
+    if constexpr (!std::is_trivially_destructible_v<T> ||
+                  !monotonic_allocator<NodeAlloc>) {
+        NodeHeader* tail = root.next;
+
+        while (tail != nullptr) {
+            NodeHeader* next = tail->next;
 
-template <typename T>
+            delete_node(tail);
+
+            tail = next;
+        }
+    }
+    root.next = nullptr;
+}
+
+template <typename T, typename A>
+ForwardList<T, A>::ForwardList() : ForwardList(A()) {}
+
+template <typename T, typename A>
+ForwardList<T, A>::ForwardList(const A& alloc) : alloc(alloc) {}
+
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-ForwardList<T>::ForwardList(std::size_t n, Args&&... args) {
+ForwardList<T, A>::ForwardList(std::size_t n, Args&&... args) : ForwardList() {
     NodeHeader* tail = &root;
 
     for (std::size_t i = 0; i < n; ++i) {
-        tail->next = new Node(nullptr, std::forward<Args>(args)...);
+        tail->next = new_node(nullptr, std::forward<Args>(args)...);
         tail = tail->next;
     }
 }
-template <typename T>
+template <typename T, typename A>
 template <std::input_iterator It, std::sentinel_for<It> Sn>
     requires std::constructible_from<std::iter_value_t<It>, T>
-ForwardList<T>::ForwardList(It begin, Sn end) {
+ForwardList<T, A>::ForwardList(It begin, Sn end, const A& alloc)
+    : ForwardList(alloc) {
     NodeHeader* tail = &root;
 
     while (begin != end) {
-        tail->next = new Node(nullptr, *begin);
+        tail->next = new_node(nullptr, *begin);
         tail = tail->next;
         ++begin;
     }
 }
-template <typename T>
-ForwardList<T>::ForwardList(std::initializer_list<T> list)
-    : ForwardList(list.begin(), list.end()) {}
-
-// Rule of Five (-2)
-template <typename T>
-ForwardList<T>::ForwardList(const ForwardList& other)
-    : ForwardList(other.cbegin(), other.cend()) {}
-
-template <typename T>
-auto ForwardList<T>::operator=(const ForwardList& other) -> ForwardList<T>& {
+template <typename T, typename A>
+ForwardList<T, A>::ForwardList(std::initializer_list<T> list, const A& alloc)
+    : ForwardList(list.begin(), list.end(), alloc) {}
+
+// Rule of Five
+template <typename T, typename A>
+ForwardList<T, A>::ForwardList(const ForwardList& other)
+    : ForwardList(other.cbegin(),
+                  other.cend(),
+                  std::allocator_traits<A>::
+                      select_on_container_copy_construction(
+                          other.get_allocator())) {}
+
+template <typename T, typename A>
+ForwardList<T, A>::ForwardList(ForwardList&& other) noexcept
+    : ForwardList(other.alloc) {
+    root.next = other.root.next;
+    other.root.next = nullptr;
+}
+
+template <typename T, typename A>
+auto ForwardList<T, A>::operator=(const ForwardList& other)
+    -> ForwardList<T, A>& {
     NodeHeader* tail = &root;
     const NodeHeader* their_tail = &other.root;
 
@@ -158,8 +243,8 @@ auto ForwardList<T>::operator=(const ForwardList& other) -> ForwardList<T>& {
             static_cast<Node*>(tail->next)->data =
                 static_cast<Node*>(their_tail->next)->data;
         } else {
-            tail->next =
-                new Node(nullptr, static_cast<Node*>(their_tail->next)->data);
+            tail->next = new_node(nullptr,
+                                  static_cast<Node*>(their_tail->next)->data);
         }
 
         tail = tail->next;
@@ -172,7 +257,7 @@ auto ForwardList<T>::operator=(const ForwardList& other) -> ForwardList<T>& {
     while (after_tail != nullptr) {
         NodeHeader* next = after_tail->next;
 
-        delete static_cast<Node*>(after_tail);
+        delete_node(after_tail);
 
         after_tail = next;
     }
@@ -180,195 +265,226 @@ auto ForwardList<T>::operator=(const ForwardList& other) -> ForwardList<T>& {
     return *this;
 }
 
-template <typename T>
-ForwardList<T>::~ForwardList() {
-    NodeHeader* tail = root.next;
+// With an allocator that can't free the other list's nodes, only the
+// elements can be moved
+template <typename T, typename A>
+auto ForwardList<T, A>::operator=(ForwardList&& other) noexcept(moves_nodes)
+    -> ForwardList<T, A>& {
+    if (&other == this) {
+        return *this;
+    }
+
+    delete_nodes();
+
+    if constexpr (!moves_nodes) {
+        if (!(alloc == other.alloc)) {
+            NodeHeader* tail = &root;
 
-    while (tail != nullptr) {
-        NodeHeader* next = tail->next;
+            for (T& el : other) {
+                tail->next = new_node(nullptr, std::move(el));
+                tail = tail->next;
+            }
+            other.clear();
 
-        delete static_cast<Node*>(tail);
+            return *this;
+        }
+    }
 
-        tail = next;
+    if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+        alloc = other.alloc;
     }
+    root.next = other.root.next;
+    other.root.next = nullptr;
+
+    return *this;
 }
 
-template <typename T>
-ForwardList<T>::iterator::iterator(NodeHeader* node) : node(node) {}
+template <typename T, typename A>
+ForwardList<T, A>::~ForwardList() {
+    delete_nodes();
+}
 
-template <typename T>
-ForwardList<T>::iterator::iterator() : node(nullptr) {}
+template <typename T, typename A>
+auto ForwardList<T, A>::get_allocator() const -> A {
+    return A(alloc);
+}
+
+template <typename T, typename A>
+ForwardList<T, A>::iterator::iterator(NodeHeader* node) : node(node) {}
 
-template <typename T>
-auto ForwardList<T>::iterator::operator==(const iterator& other) const
+template <typename T, typename A>
+ForwardList<T, A>::iterator::iterator() : node(nullptr) {}
+
+template <typename T, typename A>
+auto ForwardList<T, A>::iterator::operator==(const iterator& other) const
     -> bool = default;
 
 // Prefix
-template <typename T>
-auto ForwardList<T>::iterator::operator++() -> iterator& {
+template <typename T, typename A>
+auto ForwardList<T, A>::iterator::operator++() -> iterator& {
     node = node->next;
     return *this;
 }
 
 // Postfix
-template <typename T>
-auto ForwardList<T>::iterator::operator++(int) -> iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::iterator::operator++(int) -> iterator {
     auto old = *this;
     ++*this;
     return old;
 }
-template <typename T>
-auto ForwardList<T>::iterator::operator*() const -> T& {
+template <typename T, typename A>
+auto ForwardList<T, A>::iterator::operator*() const -> T& {
     return static_cast<Node*>(node)->data;
 }
-template <typename T>
-auto ForwardList<T>::iterator::operator->() const -> T* {
+template <typename T, typename A>
+auto ForwardList<T, A>::iterator::operator->() const -> T* {
     return &static_cast<Node*>(node)->data;
 }
 
-template <typename T>
-ForwardList<T>::const_iterator::const_iterator(NodeHeader* node) : node(node) {}
+template <typename T, typename A>
+ForwardList<T, A>::const_iterator::const_iterator(NodeHeader* node)
+    : node(node) {}
 
-template <typename T>
-ForwardList<T>::const_iterator::const_iterator() : node(nullptr) {}
+template <typename T, typename A>
+ForwardList<T, A>::const_iterator::const_iterator() : node(nullptr) {}
 
-template <typename T>
-ForwardList<T>::const_iterator::const_iterator(const iterator& non_const)
+template <typename T, typename A>
+ForwardList<T, A>::const_iterator::const_iterator(const iterator& non_const)
     : node(non_const.node) {}
 
-template <typename T>
-auto ForwardList<T>::const_iterator::operator==(
+template <typename T, typename A>
+auto ForwardList<T, A>::const_iterator::operator==(
     const const_iterator& other) const -> bool = default;
 
 // Prefix
-template <typename T>
-auto ForwardList<T>::const_iterator::operator++() -> const_iterator& {
+template <typename T, typename A>
+auto ForwardList<T, A>::const_iterator::operator++() -> const_iterator& {
     node = node->next;
     return *this;
 }
 // Postfix
-template <typename T>
-auto ForwardList<T>::const_iterator::operator++(int) -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::const_iterator::operator++(int) -> const_iterator {
     auto old = *this;
     ++*this;
     return old;
 }
-template <typename T>
-auto ForwardList<T>::const_iterator::operator*() const -> const T& {
+template <typename T, typename A>
+auto ForwardList<T, A>::const_iterator::operator*() const -> const T& {
     return static_cast<const Node*>(node)->data;
 }
-template <typename T>
-auto ForwardList<T>::const_iterator::operator->() const -> const T* {
+template <typename T, typename A>
+auto ForwardList<T, A>::const_iterator::operator->() const -> const T* {
     return &static_cast<const Node*>(node)->data;
 }
-template <typename T>
-auto ForwardList<T>::before_begin() -> iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::before_begin() -> iterator {
     return iterator(&root);
 }
-template <typename T>
-auto ForwardList<T>::begin() -> iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::begin() -> iterator {
     return iterator(root.next);
 }
-template <typename T>
-auto ForwardList<T>::end() -> iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::end() -> iterator {
     return iterator();
 }
-template <typename T>
-auto ForwardList<T>::cbefore_begin() const -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::cbefore_begin() const -> const_iterator {
     return const_iterator(&root);
 }
-template <typename T>
-auto ForwardList<T>::cbegin() const -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::cbegin() const -> const_iterator {
     return const_iterator(root.next);
 }
-template <typename T>
-auto ForwardList<T>::cend() const -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::cend() const -> const_iterator {
     return const_iterator();
 }
-template <typename T>
-auto ForwardList<T>::before_begin() const -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::before_begin() const -> const_iterator {
     return cbefore_begin();
 }
-template <typename T>
-auto ForwardList<T>::begin() const -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::begin() const -> const_iterator {
     return cbegin();
 }
-template <typename T>
-auto ForwardList<T>::end() const -> const_iterator {
+template <typename T, typename A>
+auto ForwardList<T, A>::end() const -> const_iterator {
     return cend();
 }
 
-template <typename T>
-auto ForwardList<T>::front() -> T& {
+template <typename T, typename A>
+auto ForwardList<T, A>::front() -> T& {
     return static_cast<Node*>(root.next)->data;
 }
-template <typename T>
-auto ForwardList<T>::front() const -> const T& {
+template <typename T, typename A>
+auto ForwardList<T, A>::front() const -> const T& {
     return static_cast<Node*>(root.next)->data;
 }
-template <typename T>
-auto ForwardList<T>::empty() -> bool {
+template <typename T, typename A>
+auto ForwardList<T, A>::empty() -> bool {
     return root.next == nullptr;
 }
-template <typename T>
-auto ForwardList<T>::clear() -> void {
-    this->~ForwardList();
-    root.next = nullptr;
+template <typename T, typename A>
+auto ForwardList<T, A>::clear() -> void {
+    delete_nodes();
 }
-template <typename T>
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-auto ForwardList<T>::emplace_after(iterator it, Args&&... args) -> void {
-    NodeHeader* new_node = new Node(it.node->next, std::forward<Args>(args)...);
-    it.node->next = new_node;
+auto ForwardList<T, A>::emplace_after(iterator it, Args&&... args) -> void {
+    it.node->next = new_node(it.node->next, std::forward<Args>(args)...);
 }
-template <typename T>
-auto ForwardList<T>::insert_after(iterator it, const T& value) -> void {
+template <typename T, typename A>
+auto ForwardList<T, A>::insert_after(iterator it, const T& value) -> void {
     emplace_after(it, value);
 }
-template <typename T>
-auto ForwardList<T>::insert_after(iterator it, T&& value) -> void {
+template <typename T, typename A>
+auto ForwardList<T, A>::insert_after(iterator it, T&& value) -> void {
     emplace_after(it, std::move(value));
 }
-template <typename T>
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-auto ForwardList<T>::emplace_front(Args&&... args) -> void {
+auto ForwardList<T, A>::emplace_front(Args&&... args) -> void {
     emplace_after(before_begin(), std::forward<Args>(args)...);
 }
-template <typename T>
-auto ForwardList<T>::push_front(const T& value) -> void {
+template <typename T, typename A>
+auto ForwardList<T, A>::push_front(const T& value) -> void {
     emplace_front(value);
 }
-template <typename T>
-auto ForwardList<T>::push_front(T&& value) -> void {
+template <typename T, typename A>
+auto ForwardList<T, A>::push_front(T&& value) -> void {
     emplace_front(std::move(value));
 }
-template <typename T>
-auto ForwardList<T>::erase_after(iterator it) -> void {
+template <typename T, typename A>
+auto ForwardList<T, A>::erase_after(iterator it) -> void {
     if (it.node == nullptr)
         return;
 
     if (it.node->next != nullptr) {
         NodeHeader* new_next = it.node->next->next;
 
-        delete static_cast<Node*>(it.node->next);
+        delete_node(it.node->next);
 
         it.node->next = new_next;
     }
 }
-template <typename T>
-auto ForwardList<T>::pop_front() -> void {
+template <typename T, typename A>
+auto ForwardList<T, A>::pop_front() -> void {
     erase_after(before_begin());
 }
 
-template <typename T>
-auto ForwardList<T>::operator==(const ForwardList& other) const -> bool {
+template <typename T, typename A>
+auto ForwardList<T, A>::operator==(const ForwardList& other) const -> bool {
     return std::ranges::equal(*this, other);
 }
 
-template <typename T>
-auto operator<<(std::ostream& os, const ForwardList<T>& list) -> std::ostream& {
+template <typename T, typename A>
+auto operator<<(std::ostream& os, const ForwardList<T, A>& list)
+    -> std::ostream& {
     auto begin = list.begin();
     auto end = list.end();
 
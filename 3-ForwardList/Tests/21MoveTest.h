@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../../Common/ContainerStats.h"
+#include "../../Common/NodeAllocators.h"
+#include "../ForwardList.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct MoveTest {
+    MoveTest() {
+        static_assert(std::is_nothrow_move_constructible_v<ForwardList<int>>);
+        static_assert(std::is_nothrow_move_assignable_v<ForwardList<int>>);
+
+        // Moving keeps the nodes, so their addresses, and empties the source
+        ForwardList<std::string> a{"one", "two", "three"};
+        const std::string* second = &*std::next(a.begin());
+        ForwardList<std::string> b = std::move(a);
+        assertBool(a.empty(), __LINE__, __FILE__);
+        assertBool(b == ForwardList<std::string>({"one", "two", "three"}),
+                   __LINE__, __FILE__);
+        assertBool(&*std::next(b.begin()) == second, __LINE__, __FILE__);
+
+        a.push_front("again");
+        b = std::move(a);
+        assertBool(a.empty(), __LINE__, __FILE__);
+        assertBool(b.front() == "again", __LINE__, __FILE__);
+        assertBool(std::next(b.begin()) == b.end(), __LINE__, __FILE__);
+        b = std::move(b);
+        assertBool(b.front() == "again", __LINE__, __FILE__);
+
+        // Moving allocates nothing, and old nodes are freed
+        container_stats::Stats stats;
+        using Allocator = container_stats::CountingAllocator<int>;
+        ForwardList<int, Allocator> counted({1, 2, 3}, Allocator(stats));
+        ForwardList<int, Allocator> target({4, 5}, Allocator(stats));
+        ForwardList<int, Allocator> moved = std::move(counted);
+        target = std::move(moved);
+        assertEqual(stats.allocations, 5u, __LINE__, __FILE__);
+        assertEqual(stats.live_blocks, 3, __LINE__, __FILE__);
+        assertBool(std::ranges::equal(target, std::vector{1, 2, 3}), __LINE__,
+                   __FILE__);
+
+        // Between pools the nodes can't change hands, the elements do
+        NodePool pool1;
+        NodePool pool2;
+        ForwardList<int, PoolAllocator<int>> in1({1, 2, 3},
+                                                 PoolAllocator<int>(pool1));
+        ForwardList<int, PoolAllocator<int>> in2({4},
+                                                 PoolAllocator<int>(pool2));
+        in2 = std::move(in1);
+        assertBool(std::ranges::equal(in2, std::vector{1, 2, 3}), __LINE__,
+                   __FILE__);
+        assertBool(in1.empty(), __LINE__, __FILE__);
+
+        // Inserting an rvalue moves it in
+        ForwardList<std::string> strings;
+        std::string text(100, 'a');
+        strings.push_front(std::move(text));
+        assertBool(text.empty(), __LINE__, __FILE__);
+        text.assign(100, 'b');
+        strings.insert_after(strings.begin(), std::move(text));
+        assertBool(text.empty(), __LINE__, __FILE__);
+        assertBool(*std::next(strings.begin()) == std::string(100, 'b'),
+                   __LINE__, __FILE__);
+    }
+};
+
+static MoveTest moveTest;
+}  // namespace test
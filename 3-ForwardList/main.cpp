@@ -21,6 +21,8 @@
 #include "Tests/17InsertTest.h"
 #include "Tests/18EraseTest.h"
 #include "Tests/19StlCompatibilityTest.h"
+#include "Tests/20AllocatorTest.h"
+#include "Tests/21MoveTest.h"
 
 auto main() -> int {
     std::cout << "All tests have passed :3\n";
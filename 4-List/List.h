@@ -1,20 +1,28 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <compare>
 #include <concepts>
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
+#include "../Common/NodeAllocators.h"
+
 // List's representation is actually circular,
 // so list with A, B, and C will look like:
 //     -> A <-> B <-> C <-> nullnode <-
 // The List just contains nullnode as its only data member,
 // which holds prev and next pointers.
 // In empty list both next and prev of nullnode are pointing to itself.
-template <typename T>
+// The number of elements is kept alongside, so size() doesn't walk.
+// Nodes come from `A`, rebound to the node type.
+template <typename T, typename A = std::allocator<T>>
 class List {
     struct NodeHeader {
         NodeHeader* next;
@@ -30,23 +38,60 @@ class List {
         Node(NodeHeader* prev, NodeHeader* next, Args&&... args);
     };
 
+    using NodeAlloc =
+        typename std::allocator_traits<A>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    // Whether move assignment can always take the other list's nodes
+    static constexpr bool moves_nodes =
+        NodeTraits::propagate_on_container_move_assignment::value ||
+        NodeTraits::is_always_equal::value;
+
     NodeHeader nullnode;
+    std::size_t count = 0;
+    [[no_unique_address]]
+    NodeAlloc alloc;
+
+    template <typename... Args>
+    auto new_node(NodeHeader* prev, NodeHeader* next, Args&&... args)
+        -> Node*;
+    auto delete_node(NodeHeader* node) -> void;
+    auto delete_nodes() -> void;
+
+    // Merges two null-terminated chains linked through `next` only,
+    // taking from `first` on ties
+    template <typename Compare>
+    static auto merge_chains(NodeHeader* first,
+                             NodeHeader* second,
+                             Compare& comp) -> NodeHeader*;
+    // Relinks [first, last) right before `pos`, which is outside of it
+    // or `first`
+    static auto transfer(NodeHeader* pos, NodeHeader* first, NodeHeader* last)
+        -> void;
 
   public:
+    using allocator_type = A;
+
     List();
+    explicit List(const A& alloc);
     template <typename... Args>
         requires requires(Args... args) { T(std::forward<Args>(args)...); }
     explicit List(std::size_t n, Args&&... args);
 
     template <std::input_iterator It, std::sentinel_for<It> Sn>
         requires std::constructible_from<std::iter_value_t<It>, T>
-    List(It begin, Sn end);
-    List(std::initializer_list<T> list);
+    List(It begin, Sn end, const A& alloc = A());
+    List(std::initializer_list<T> list, const A& alloc = A());
 
     List(const List& other);
+    // Moving takes the nodes over, the sentinel stays with each list
+    List(List&& other) noexcept;
     auto operator=(const List& other) -> List&;
+    auto operator=(List&& other) noexcept(moves_nodes) -> List&;
     ~List();
 
+    auto get_allocator() const -> A;
+
     class iterator {
         friend class List;
         NodeHeader* node;
@@ -156,22 +201,53 @@ class List {
     auto front() const -> const T&;
     auto back() -> T&;
     auto back() const -> const T&;
-    auto size() -> std::size_t;
+    auto size() const -> std::size_t;
 
     template <typename... Args>
         requires requires(Args... args) { T(std::forward<Args>(args)...); }
     auto emplace(const_iterator it, Args&&... args) -> void;
     auto insert(const_iterator it, const T& item) -> void;
+    auto insert(const_iterator it, T&& item) -> void;
+    template <typename... Args>
+        requires requires(Args... args) { T(std::forward<Args>(args)...); }
+    auto emplace_front(Args&&... args) -> void;
+    template <typename... Args>
+        requires requires(Args... args) { T(std::forward<Args>(args)...); }
+    auto emplace_back(Args&&... args) -> void;
     auto push_front(const T& item) -> void;
+    auto push_front(T&& item) -> void;
     auto push_back(const T& item) -> void;
+    auto push_back(T&& item) -> void;
     auto erase(const_iterator it) -> const_iterator;
     auto erase(iterator it) -> iterator;
     auto pop_front() -> void;
     auto pop_back() -> void;
     auto clear() -> void;
 
+    // Moves nodes of `other`, which may be this list, to right before `pos`
+    // in O(1) without allocating. Iterators to them stay valid and now point
+    // into this list. `other` must use an equal allocator.
+    // A range from another list takes linear time, to count it.
+    auto splice(const_iterator pos, List& other) -> void;
+    auto splice(const_iterator pos, List&& other) -> void;
+    auto splice(const_iterator pos, List& other, const_iterator it) -> void;
+    auto splice(const_iterator pos, List&& other, const_iterator it) -> void;
+    auto splice(const_iterator pos,
+                List& other,
+                const_iterator first,
+                const_iterator last) -> void;
+    auto splice(const_iterator pos,
+                List&& other,
+                const_iterator first,
+                const_iterator last) -> void;
+
     // Merges two sorted lists
     auto merge(const List& other) -> void;
+    // Same, but relinks the nodes of `other` instead of copying them,
+    // leaving it empty. Stable: of equal elements, ours come first.
+    // `other` must use an equal allocator.
+    template <typename Compare = std::less<>>
+    auto merge(List&& other, Compare comp = Compare()) -> void;
     auto pop_and_insert(iterator pop_from, iterator insert_to) -> iterator;
 
     auto insertion_sort() -> void
@@ -179,49 +255,106 @@ class List {
     auto quick_sort() -> void  // always faster
         requires std::swappable<T> && std::three_way_comparable<T>;
 
-    auto sort() -> void;
+    // Stable merge sort that relinks nodes, elements never move
+    template <typename Compare = std::less<>>
+    auto sort(Compare comp = Compare()) -> void;
 };
 
-template <typename T>
-List<T>::NodeHeader::NodeHeader(NodeHeader* prev, NodeHeader* next)
+template <typename T, typename A>
+List<T, A>::NodeHeader::NodeHeader(NodeHeader* prev, NodeHeader* next)
     : next(next), prev(prev) {}
 
-template <typename T>
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-List<T>::Node::Node(NodeHeader* prev, NodeHeader* next, Args&&... args)
+List<T, A>::Node::Node(NodeHeader* prev, NodeHeader* next, Args&&... args)
     : NodeHeader(prev, next), data(std::forward<Args>(args)...) {}
 
-template <typename T>
-List<T>::List() : nullnode(&nullnode, &nullnode) {}  // emptty list
+template <typename T, typename A>
+template <typename... Args>
+auto List<T, A>::new_node(NodeHeader* prev, NodeHeader* next, Args&&... args)
+    -> Node* {
+    Node* node = NodeTraits::allocate(alloc, 1);
+    try {
+        NodeTraits::construct(alloc, node, prev, next,
+                              std::forward<Args>(args)...);
+    } catch (...) {
+        NodeTraits::deallocate(alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template <typename T, typename A>
+auto List<T, A>::delete_node(NodeHeader* node) -> void {
+    Node* full_node = static_cast<Node*>(node);
+    NodeTraits::destroy(alloc, full_node);
+    NodeTraits::deallocate(alloc, full_node, 1);
+}
+
+// With nothing to destroy in an arena that frees nothing one by one,
+// the nodes don't even need visiting
+template <typename T, typename A>
+auto List<T, A>::delete_nodes() -> void {
+    if constexpr (!std::is_trivially_destructible_v<T> ||
+                  !monotonic_allocator<NodeAlloc>) {
+        NodeHeader* current = nullnode.next;
 
-template <typename T>
+        while (current != &nullnode) {
+            NodeHeader* next = current->next;
+            delete_node(current);
+            current = next;
+        }
+    }
+    nullnode.next = &nullnode;
+    nullnode.prev = &nullnode;
+    count = 0;
+}
+
+template <typename T, typename A>
+List<T, A>::List() : List(A()) {}
+
+template <typename T, typename A>
+List<T, A>::List(const A& alloc)
+    : nullnode(&nullnode, &nullnode), alloc(alloc) {}  // emptty list
+
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-List<T>::List(std::size_t n, Args&&... args) : List() {
+List<T, A>::List(std::size_t n, Args&&... args) : List() {
     for (std::size_t i = 0; i < n; ++i) {
         emplace(end(), std::forward<Args>(args)...);
     }
 }
 
-template <typename T>
+template <typename T, typename A>
 template <std::input_iterator It, std::sentinel_for<It> Sn>
     requires std::constructible_from<std::iter_value_t<It>, T>
-List<T>::List(It begin, Sn end) : List() {
+List<T, A>::List(It begin, Sn end, const A& alloc) : List(alloc) {
     while (begin != end) {
         push_back(*begin);
         ++begin;
     }
 }
 
-template <typename T>
-List<T>::List(std::initializer_list<T> list) : List(list.begin(), list.end()) {}
+template <typename T, typename A>
+List<T, A>::List(std::initializer_list<T> list, const A& alloc)
+    : List(list.begin(), list.end(), alloc) {}
 
-template <typename T>
-List<T>::List(const List& other) : List(other.begin(), other.end()) {}
+template <typename T, typename A>
+List<T, A>::List(const List& other)
+    : List(other.begin(),
+           other.end(),
+           std::allocator_traits<A>::select_on_container_copy_construction(
+               other.get_allocator())) {}
 
-template <typename T>
-auto List<T>::operator=(const List& other) -> List<T>& {
+template <typename T, typename A>
+List<T, A>::List(List&& other) noexcept : List(other.alloc) {
+    splice(end(), other);
+}
+
+template <typename T, typename A>
+auto List<T, A>::operator=(const List& other) -> List<T, A>& {
     if (&other == this) {
         return *this;
     }
@@ -244,108 +377,245 @@ auto List<T>::operator=(const List& other) -> List<T>& {
     return *this;
 }
 
-template <typename T>
-List<T>::~List() {
-    NodeHeader* current = nullnode.next;
+// With an allocator that can't free the other list's nodes, only the
+// elements can be moved
+template <typename T, typename A>
+auto List<T, A>::operator=(List&& other) noexcept(moves_nodes)
+    -> List<T, A>& {
+    if (&other == this) {
+        return *this;
+    }
 
-    while (current != &nullnode) {
-        NodeHeader* next = current->next;
-        delete static_cast<Node*>(current);
-        current = next;
+    if constexpr (!moves_nodes) {
+        if (!(alloc == other.alloc)) {
+            iterator it = begin();
+
+            for (T& el : other) {
+                if (it == end()) {
+                    emplace(it, std::move(el));
+                } else {
+                    *it = std::move(el);
+                    ++it;
+                }
+            }
+
+            while (it != end()) {
+                it = erase(it);
+            }
+            other.clear();
+
+            return *this;
+        }
     }
+
+    delete_nodes();
+    if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+        alloc = other.alloc;
+    }
+    splice(end(), other);
+
+    return *this;
 }
 
-template <typename T>
-auto List<T>::empty() -> bool {
+template <typename T, typename A>
+List<T, A>::~List() {
+    delete_nodes();
+}
+
+template <typename T, typename A>
+auto List<T, A>::get_allocator() const -> A {
+    return A(alloc);
+}
+
+template <typename T, typename A>
+auto List<T, A>::empty() -> bool {
     return nullnode.prev == &nullnode;
 }
-template <typename T>
-auto List<T>::front() -> T& {
+template <typename T, typename A>
+auto List<T, A>::front() -> T& {
     return static_cast<Node*>(nullnode.next)->data;
 }
-template <typename T>
-auto List<T>::front() const -> const T& {
+template <typename T, typename A>
+auto List<T, A>::front() const -> const T& {
     return static_cast<Node*>(nullnode.next)->data;
 }
-template <typename T>
-auto List<T>::back() -> T& {
+template <typename T, typename A>
+auto List<T, A>::back() -> T& {
     return static_cast<Node*>(nullnode.prev)->data;
 }
-template <typename T>
-auto List<T>::back() const -> const T& {
+template <typename T, typename A>
+auto List<T, A>::back() const -> const T& {
     return static_cast<Node*>(nullnode.prev)->data;
 }
 
-template <typename T>
-auto List<T>::size() -> std::size_t {
-    return std::distance(begin(), end());
+template <typename T, typename A>
+auto List<T, A>::size() const -> std::size_t {
+    return count;
 }
 
-template <typename T>
-auto List<T>::operator==(const List& other) const -> bool {
+template <typename T, typename A>
+auto List<T, A>::operator==(const List& other) const -> bool {
     return std::ranges::equal(*this, other);
 }
 
-template <typename T>
+template <typename T, typename A>
 template <typename... Args>
     requires requires(Args... args) { T(std::forward<Args>(args)...); }
-auto List<T>::emplace(const_iterator it, Args&&... args) -> void {
-    Node* new_node =
-        new Node(it.node->prev, it.node, std::forward<Args>(args)...);
-    it.node->prev->next = new_node;
-    it.node->prev = new_node;
+auto List<T, A>::emplace(const_iterator it, Args&&... args) -> void {
+    Node* node = new_node(it.node->prev, it.node, std::forward<Args>(args)...);
+    it.node->prev->next = node;
+    it.node->prev = node;
+    ++count;
 }
 
-template <typename T>
-auto List<T>::insert(const_iterator it, const T& item) -> void {
+template <typename T, typename A>
+auto List<T, A>::insert(const_iterator it, const T& item) -> void {
     emplace(it, item);
 }
 
-template <typename T>
-auto List<T>::push_front(const T& item) -> void {
+template <typename T, typename A>
+auto List<T, A>::insert(const_iterator it, T&& item) -> void {
+    emplace(it, std::move(item));
+}
+
+template <typename T, typename A>
+template <typename... Args>
+    requires requires(Args... args) { T(std::forward<Args>(args)...); }
+auto List<T, A>::emplace_front(Args&&... args) -> void {
+    emplace(begin(), std::forward<Args>(args)...);
+}
+
+template <typename T, typename A>
+template <typename... Args>
+    requires requires(Args... args) { T(std::forward<Args>(args)...); }
+auto List<T, A>::emplace_back(Args&&... args) -> void {
+    emplace(end(), std::forward<Args>(args)...);
+}
+
+template <typename T, typename A>
+auto List<T, A>::push_front(const T& item) -> void {
     emplace(begin(), item);
 }
 
-template <typename T>
-auto List<T>::push_back(const T& item) -> void {
+template <typename T, typename A>
+auto List<T, A>::push_front(T&& item) -> void {
+    emplace(begin(), std::move(item));
+}
+
+template <typename T, typename A>
+auto List<T, A>::push_back(const T& item) -> void {
     emplace(end(), item);
 }
 
-template <typename T>
-auto List<T>::erase(const_iterator it) -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::push_back(T&& item) -> void {
+    emplace(end(), std::move(item));
+}
+
+template <typename T, typename A>
+auto List<T, A>::erase(const_iterator it) -> const_iterator {
     it.node->prev->next = it.node->next;
     it.node->next->prev = it.node->prev;
     iterator new_it = iterator(it.node->next);
-    delete static_cast<Node*>(it.node);
+    delete_node(it.node);
+    --count;
     return new_it;
 }
 
-template <typename T>
-auto List<T>::erase(iterator it) -> iterator {
+template <typename T, typename A>
+auto List<T, A>::erase(iterator it) -> iterator {
     it.node->prev->next = it.node->next;
     it.node->next->prev = it.node->prev;
     auto new_it = iterator(it.node->next);
-    delete static_cast<Node*>(it.node);
+    delete_node(it.node);
+    --count;
     return new_it;
 }
 
-template <typename T>
-auto List<T>::pop_front() -> void {
+template <typename T, typename A>
+auto List<T, A>::pop_front() -> void {
     erase(begin());
 }
-template <typename T>
-auto List<T>::pop_back() -> void {
+template <typename T, typename A>
+auto List<T, A>::pop_back() -> void {
     erase(std::prev(end()));
 }
 
-template <typename T>
-auto List<T>::clear() -> void {
-    std::destroy_at(this);
-    std::construct_at(this);
+template <typename T, typename A>
+auto List<T, A>::clear() -> void {
+    delete_nodes();
+}
+
+template <typename T, typename A>
+auto List<T, A>::transfer(NodeHeader* pos, NodeHeader* first, NodeHeader* last)
+    -> void {
+    if (first == last || pos == first || pos == last) {
+        return;
+    }
+    NodeHeader* tail = last->prev;
+
+    first->prev->next = last;
+    last->prev = first->prev;
+
+    first->prev = pos->prev;
+    tail->next = pos;
+    pos->prev->next = first;
+    pos->prev = tail;
+}
+
+template <typename T, typename A>
+auto List<T, A>::splice(const_iterator pos, List& other) -> void {
+    if (&other != this) {
+        transfer(pos.node, other.nullnode.next, &other.nullnode);
+        count += other.count;
+        other.count = 0;
+    }
+}
+
+template <typename T, typename A>
+auto List<T, A>::splice(const_iterator pos, List&& other) -> void {
+    splice(pos, other);
 }
 
-template <typename T>
-auto List<T>::merge(const List& other) -> void {
+template <typename T, typename A>
+auto List<T, A>::splice(const_iterator pos, List& other, const_iterator it)
+    -> void {
+    transfer(pos.node, it.node, it.node->next);
+    if (&other != this) {
+        ++count;
+        --other.count;
+    }
+}
+
+template <typename T, typename A>
+auto List<T, A>::splice(const_iterator pos, List&& other, const_iterator it)
+    -> void {
+    splice(pos, other, it);
+}
+
+template <typename T, typename A>
+auto List<T, A>::splice(const_iterator pos,
+                        List& other,
+                        const_iterator first,
+                        const_iterator last) -> void {
+    if (&other != this) {
+        auto moved = static_cast<std::size_t>(std::distance(first, last));
+        count += moved;
+        other.count -= moved;
+    }
+    transfer(pos.node, first.node, last.node);
+}
+
+template <typename T, typename A>
+auto List<T, A>::splice(const_iterator pos,
+                        List&& other,
+                        const_iterator first,
+                        const_iterator last) -> void {
+    splice(pos, other, first, last);
+}
+
+template <typename T, typename A>
+auto List<T, A>::merge(const List& other) -> void {
     auto me = begin();
     auto him = other.begin();
 
@@ -359,8 +629,45 @@ auto List<T>::merge(const List& other) -> void {
     }
 }
 
-template <typename T>
-auto List<T>::pop_and_insert(iterator pop_from, iterator insert_to)
+template <typename T, typename A>
+template <typename Compare>
+auto List<T, A>::merge(List&& other, Compare comp) -> void {
+    if (&other == this) {
+        return;
+    }
+
+    count += other.count;
+    other.count = 0;
+
+    NodeHeader* me = nullnode.next;
+    NodeHeader* him = other.nullnode.next;
+    NodeHeader* his_end = &other.nullnode;
+
+    while (him != his_end) {
+        if (me == &nullnode) {
+            transfer(me, him, his_end);
+            break;
+        }
+
+        const T& mine = static_cast<Node*>(me)->data;
+        if (!comp(static_cast<Node*>(him)->data, mine)) {
+            me = me->next;
+            continue;
+        }
+
+        // Moves the whole run of his that goes before mine at once
+        NodeHeader* run_end = him->next;
+        while (run_end != his_end &&
+               comp(static_cast<Node*>(run_end)->data, mine)) {
+            run_end = run_end->next;
+        }
+        transfer(me, him, run_end);
+        him = run_end;
+    }
+}
+
+template <typename T, typename A>
+auto List<T, A>::pop_and_insert(iterator pop_from, iterator insert_to)
     -> iterator {
     auto after_poped = pop_from.node->next;
 
@@ -376,8 +683,8 @@ auto List<T>::pop_and_insert(iterator pop_from, iterator insert_to)
     return iterator(after_poped);
 }
 
-template <typename T>
-auto List<T>::insertion_sort() -> void
+template <typename T, typename A>
+auto List<T, A>::insertion_sort() -> void
     requires std::three_way_comparable<T>
 {
     if (empty()) {
@@ -437,284 +744,350 @@ auto quick_sort_rec(It from, It to) -> void {
     quick_sort_rec(std::next(pivot), to);
 }
 
-template <typename T>
-auto List<T>::quick_sort() -> void
+template <typename T, typename A>
+auto List<T, A>::quick_sort() -> void
     requires std::swappable<T> && std::three_way_comparable<T>
 {
     quick_sort_rec(begin(), end());
 }
 
-template <typename T>
-auto List<T>::sort() -> void {
-    quick_sort();
+template <typename T, typename A>
+template <typename Compare>
+auto List<T, A>::merge_chains(NodeHeader* first,
+                              NodeHeader* second,
+                              Compare& comp) -> NodeHeader* {
+    NodeHeader head(nullptr, nullptr);
+    NodeHeader* tail = &head;
+
+    while (first != nullptr && second != nullptr) {
+        if (comp(static_cast<Node*>(second)->data,
+                 static_cast<Node*>(first)->data)) {
+            tail->next = second;
+            second = second->next;
+        } else {
+            tail->next = first;
+            first = first->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = first != nullptr ? first : second;
+
+    return head.next;
+}
+
+// Bottom-up: runs[i] is empty or holds 2^i sorted nodes, and runs further
+// up came earlier in the list. Adding a node carries like a binary counter.
+template <typename T, typename A>
+template <typename Compare>
+auto List<T, A>::sort(Compare comp) -> void {
+    if (nullnode.next == nullnode.prev) {
+        return;  // 0 or 1 elements
+    }
+
+    std::array<NodeHeader*, 64> runs{};
+    std::size_t used = 0;
+
+    nullnode.prev->next = nullptr;
+    NodeHeader* rest = nullnode.next;
+
+    while (rest != nullptr) {
+        NodeHeader* carry = rest;
+        rest = rest->next;
+        carry->next = nullptr;
+
+        std::size_t i = 0;
+        for (; runs[i] != nullptr; ++i) {
+            carry = merge_chains(runs[i], carry, comp);
+            runs[i] = nullptr;
+        }
+        runs[i] = carry;
+        used = std::max(used, i + 1);
+    }
+
+    NodeHeader* sorted = nullptr;
+    for (std::size_t i = 0; i < used; ++i) {
+        sorted = merge_chains(runs[i], sorted, comp);
+    }
+
+    // Only `next` was kept up, restore `prev` and close the circle
+    NodeHeader* prev = &nullnode;
+    for (NodeHeader* node = sorted; node != nullptr; node = node->next) {
+        prev->next = node;
+        node->prev = prev;
+        prev = node;
+    }
+    prev->next = &nullnode;
+    nullnode.prev = prev;
 }
 // ## List::iterator
-template <typename T>
-List<T>::iterator::iterator(NodeHeader* node) : node(node) {}
+template <typename T, typename A>
+List<T, A>::iterator::iterator(NodeHeader* node) : node(node) {}
 
-template <typename T>
-List<T>::iterator::iterator()
+template <typename T, typename A>
+List<T, A>::iterator::iterator()
     : node(nullptr) {}  // this iterator will be invalid
 
-template <typename T>
-auto List<T>::iterator::operator==(const iterator& other) const
+template <typename T, typename A>
+auto List<T, A>::iterator::operator==(const iterator& other) const
     -> bool = default;
 
-template <typename T>
-auto List<T>::iterator::operator++() -> iterator& {
+template <typename T, typename A>
+auto List<T, A>::iterator::operator++() -> iterator& {
     node = node->next;
     return *this;
 }
 
-template <typename T>
-auto List<T>::iterator::operator++(int) -> iterator {
+template <typename T, typename A>
+auto List<T, A>::iterator::operator++(int) -> iterator {
     auto old = *this;
     ++*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::iterator::operator--() -> iterator& {
+template <typename T, typename A>
+auto List<T, A>::iterator::operator--() -> iterator& {
     node = node->prev;
     return *this;
 }
 
-template <typename T>
-auto List<T>::iterator::operator--(int) -> iterator {
+template <typename T, typename A>
+auto List<T, A>::iterator::operator--(int) -> iterator {
     auto old = *this;
     --*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::iterator::operator*() const -> T& {
+template <typename T, typename A>
+auto List<T, A>::iterator::operator*() const -> T& {
     return static_cast<Node*>(node)->data;
 }
 
-template <typename T>
-auto List<T>::iterator::operator->() const -> T* {
+template <typename T, typename A>
+auto List<T, A>::iterator::operator->() const -> T* {
     return &static_cast<Node*>(node)->data;
 }
 
 // ## List::const_iterator
 
-template <typename T>
-List<T>::const_iterator::const_iterator(NodeHeader* node) : node(node) {}
+template <typename T, typename A>
+List<T, A>::const_iterator::const_iterator(NodeHeader* node) : node(node) {}
 
-template <typename T>
-List<T>::const_iterator::const_iterator()
+template <typename T, typename A>
+List<T, A>::const_iterator::const_iterator()
     : node(nullptr) {}  // this iterator will be invalid
 
-template <typename T>
-List<T>::const_iterator::const_iterator(iterator it) : node(it.node) {}
+template <typename T, typename A>
+List<T, A>::const_iterator::const_iterator(iterator it) : node(it.node) {}
 
-template <typename T>
-auto List<T>::const_iterator::operator==(const const_iterator& other) const
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator==(const const_iterator& other) const
     -> bool = default;
 
-template <typename T>
-auto List<T>::const_iterator::operator++() -> const_iterator& {
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator++() -> const_iterator& {
     node = node->next;
     return *this;
 }
 
-template <typename T>
-auto List<T>::const_iterator::operator++(int) -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator++(int) -> const_iterator {
     auto old = *this;
     ++*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::const_iterator::operator--() -> const_iterator& {
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator--() -> const_iterator& {
     node = node->prev;
     return *this;
 }
 
-template <typename T>
-auto List<T>::const_iterator::operator--(int) -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator--(int) -> const_iterator {
     auto old = *this;
     --*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::const_iterator::operator*() const -> const T& {
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator*() const -> const T& {
     return static_cast<const Node*>(node)->data;
 }
 
-template <typename T>
-auto List<T>::const_iterator::operator->() const -> const T* {
+template <typename T, typename A>
+auto List<T, A>::const_iterator::operator->() const -> const T* {
     return &static_cast<const Node*>(node)->data;
 }
 
-template <typename T>
-auto List<T>::begin() -> iterator {
+template <typename T, typename A>
+auto List<T, A>::begin() -> iterator {
     return iterator(nullnode.next);
 }
 
-template <typename T>
-auto List<T>::end() -> iterator {
+template <typename T, typename A>
+auto List<T, A>::end() -> iterator {
     return iterator(&nullnode);
 }
 
-template <typename T>
-auto List<T>::begin() const -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::begin() const -> const_iterator {
     return const_iterator(nullnode.next);
 }
 
-template <typename T>
-auto List<T>::end() const -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::end() const -> const_iterator {
     return const_iterator(const_cast<NodeHeader*>(&nullnode));
 }
 
-template <typename T>
-auto List<T>::cbegin() const -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::cbegin() const -> const_iterator {
     return begin();
 }
 
-template <typename T>
-auto List<T>::cend() const -> const_iterator {
+template <typename T, typename A>
+auto List<T, A>::cend() const -> const_iterator {
     return end();
 }
 
 // ## List::reverse_iterator
 
-template <typename T>
-List<T>::reverse_iterator::reverse_iterator(NodeHeader* node) : node(node) {}
+template <typename T, typename A>
+List<T, A>::reverse_iterator::reverse_iterator(NodeHeader* node) : node(node) {}
 
-template <typename T>
-List<T>::reverse_iterator::reverse_iterator()
+template <typename T, typename A>
+List<T, A>::reverse_iterator::reverse_iterator()
     : node(nullptr) {}  // this iterator will be invalid
 
-template <typename T>
-auto List<T>::reverse_iterator::operator==(const reverse_iterator& other) const
-    -> bool = default;
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator==(
+    const reverse_iterator& other) const -> bool = default;
 
-template <typename T>
-auto List<T>::reverse_iterator::operator++() -> reverse_iterator& {
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator++() -> reverse_iterator& {
     node = node->prev;
     return *this;
 }
 
-template <typename T>
-auto List<T>::reverse_iterator::operator++(int) -> reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator++(int) -> reverse_iterator {
     auto old = *this;
     ++*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::reverse_iterator::operator--() -> reverse_iterator& {
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator--() -> reverse_iterator& {
     node = node->next;
     return *this;
 }
 
-template <typename T>
-auto List<T>::reverse_iterator::operator--(int) -> reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator--(int) -> reverse_iterator {
     auto old = *this;
     --*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::reverse_iterator::operator*() const -> T& {
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator*() const -> T& {
     return static_cast<Node*>(node)->data;
 }
 
-template <typename T>
-auto List<T>::reverse_iterator::operator->() const -> T* {
+template <typename T, typename A>
+auto List<T, A>::reverse_iterator::operator->() const -> T* {
     return &static_cast<Node*>(node)->data;
 }
 
 // ## List::const_reverse_iterator
 
-template <typename T>
-List<T>::const_reverse_iterator::const_reverse_iterator(NodeHeader* node)
+template <typename T, typename A>
+List<T, A>::const_reverse_iterator::const_reverse_iterator(NodeHeader* node)
     : node(node) {}
 
-template <typename T>
-List<T>::const_reverse_iterator::const_reverse_iterator()
+template <typename T, typename A>
+List<T, A>::const_reverse_iterator::const_reverse_iterator()
     : node(nullptr) {}  // this iterator will be invalid
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator==(
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator==(
     const const_reverse_iterator& other) const -> bool = default;
 
-template <typename T>
-List<T>::const_reverse_iterator::const_reverse_iterator(reverse_iterator it)
+template <typename T, typename A>
+List<T, A>::const_reverse_iterator::const_reverse_iterator(reverse_iterator it)
     : node(it.node) {}
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator++() -> const_reverse_iterator& {
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator++()
+    -> const_reverse_iterator& {
     node = node->prev;
     return *this;
 }
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator++(int)
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator++(int)
     -> const_reverse_iterator {
     auto old = *this;
     ++*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator--() -> const_reverse_iterator& {
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator--()
+    -> const_reverse_iterator& {
     node = node->next;
     return *this;
 }
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator--(int)
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator--(int)
     -> const_reverse_iterator {
     auto old = *this;
     --*this;
     return old;
 }
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator*() const -> const T& {
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator*() const -> const T& {
     return static_cast<const Node*>(node)->data;
 }
 
-template <typename T>
-auto List<T>::const_reverse_iterator::operator->() const -> const T* {
+template <typename T, typename A>
+auto List<T, A>::const_reverse_iterator::operator->() const -> const T* {
     return &static_cast<const Node*>(node)->data;
 }
 
-template <typename T>
-auto List<T>::rbegin() -> reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::rbegin() -> reverse_iterator {
     return reverse_iterator(nullnode.prev);
 }
 
-template <typename T>
-auto List<T>::rend() -> reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::rend() -> reverse_iterator {
     return reverse_iterator(&nullnode);
 }
 
-template <typename T>
-auto List<T>::rbegin() const -> const_reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::rbegin() const -> const_reverse_iterator {
     return const_reverse_iterator(nullnode.prev);
 }
 
-template <typename T>
-auto List<T>::rend() const -> const_reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::rend() const -> const_reverse_iterator {
     return const_reverse_iterator(const_cast<NodeHeader*>(&nullnode));
 }
 
-template <typename T>
-auto List<T>::crbegin() const -> const_reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::crbegin() const -> const_reverse_iterator {
     return rbegin();
 }
 
-template <typename T>
-auto List<T>::crend() const -> const_reverse_iterator {
+template <typename T, typename A>
+auto List<T, A>::crend() const -> const_reverse_iterator {
     return rend();
 }
 
-template <typename T>
-auto operator<<(std::ostream& os, const List<T>& list) -> std::ostream& {
+template <typename T, typename A>
+auto operator<<(std::ostream& os, const List<T, A>& list) -> std::ostream& {
     auto begin = list.begin();
     auto end = list.end();
 
@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include "../../Common/ContainerStats.h"
+#include "../../Common/NodeAllocators.h"
+#include "../List.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct AllocatorTest {
+    AllocatorTest() {
+        // One allocation per node, and every one of them is given back
+        container_stats::Stats stats;
+        {
+            using Allocator = container_stats::CountingAllocator<std::string>;
+            List<std::string, Allocator> lst{Allocator(stats)};
+            for (int i = 0; i < 100; ++i) {
+                lst.push_back(std::to_string(i));
+            }
+            assertEqual(stats.allocations, 100u, __LINE__, __FILE__);
+
+            for (int i = 0; i < 20; ++i) {
+                lst.pop_front();
+                lst.pop_back();
+            }
+            List<std::string, Allocator> copy = lst;
+            assertBool(copy == lst, __LINE__, __FILE__);
+            lst.clear();
+            assertEqual(stats.live_blocks, 60, __LINE__, __FILE__);
+        }
+        assertEqual(stats.allocations, 160u, __LINE__, __FILE__);
+        assertEqual(stats.live_blocks, 0, __LINE__, __FILE__);
+
+        // A pool hands freed nodes back out before carving new chunks
+        NodePool pool(64);
+        {
+            List<int, PoolAllocator<int>> lst{PoolAllocator<int>(pool)};
+            for (int i = 0; i < 64; ++i) {
+                lst.push_back(i);
+            }
+            assertEqual(pool.chunk_count(), 1u, __LINE__, __FILE__);
+            for (int round = 0; round < 10; ++round) {
+                for (int i = 0; i < 32; ++i) {
+                    lst.pop_front();
+                }
+                for (int i = 0; i < 32; ++i) {
+                    lst.push_back(i);
+                }
+            }
+            assertEqual(pool.chunk_count(), 1u, __LINE__, __FILE__);
+            lst.push_back(64);
+            assertEqual(pool.chunk_count(), 2u, __LINE__, __FILE__);
+        }
+
+        // An arena-backed list of ints is dropped without a walk,
+        // and works like any other until then
+        Arena arena(256);
+        {
+            List<int, ArenaAllocator<int>> lst({3, 1, 2},
+                                               ArenaAllocator<int>(arena));
+            for (int i = 0; i < 1000; ++i) {
+                lst.insert(std::next(lst.begin()), i);
+            }
+            lst.erase(std::next(lst.begin()));
+            lst.sort();
+            assertEqual(lst.size(), 1002u, __LINE__, __FILE__);
+            assertEqual(lst.front(), 0, __LINE__, __FILE__);
+            assertEqual(lst.back(), 998, __LINE__, __FILE__);
+            assertBool(std::ranges::is_sorted(lst), __LINE__, __FILE__);
+            lst.clear();
+            assertBool(lst.empty(), __LINE__, __FILE__);
+            lst.push_back(5);
+            assertEqual(lst.front(), 5, __LINE__, __FILE__);
+        }
+    }
+};
+
+static AllocatorTest allocatorTest;
+}  // namespace test
@@ -0,0 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../List.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct MergeSortTest {
+    MergeSortTest() {
+        List<int> empty;
+        empty.sort();
+        assertBool(empty.empty(), __LINE__, __FILE__);
+
+        List<int> single{42};
+        single.sort();
+        assertEqual(single.front(), 42, __LINE__, __FILE__);
+        assertEqual(single.back(), 42, __LINE__, __FILE__);
+
+        // Already sorted and reversed input, the worst case of a quick sort
+        // with the first element as pivot
+        constexpr int n = 100000;
+        List<int> ascending;
+        List<int> descending;
+        for (int i = 0; i < n; ++i) {
+            ascending.push_back(i);
+            descending.push_front(i);
+        }
+        ascending.sort();
+        descending.sort();
+        assertBool(ascending == descending, __LINE__, __FILE__);
+        assertBool(std::ranges::is_sorted(ascending), __LINE__, __FILE__);
+
+        // Equal keys keep their order
+        std::mt19937 rng(24);
+        std::uniform_int_distribution<int> dist(0, 50);
+        List<std::pair<int, int>> pairs;
+        std::vector<std::pair<int, int>> expected;
+        for (int i = 0; i < 3001; ++i) {
+            pairs.push_back({dist(rng), i});
+            expected.push_back(pairs.back());
+        }
+        auto by_key = [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        };
+        pairs.sort(by_key);
+        std::ranges::stable_sort(expected, by_key);
+        assertBool(std::ranges::equal(pairs, expected), __LINE__, __FILE__);
+
+        // Nodes are relinked, not their values: every element stays where
+        // it lives, and walking back gives the same order reversed
+        List<int> shuffled;
+        std::vector<const int*> addresses(1000);
+        for (int i = 0; i < 1000; ++i) {
+            shuffled.push_back((i * 7919) % 1000);
+            addresses[shuffled.back()] = &shuffled.back();
+        }
+        shuffled.sort(std::greater<>());
+        int expected_value = 999;
+        for (const int& value : shuffled) {
+            assertEqual(value, expected_value, __LINE__, __FILE__);
+            assertBool(&value == addresses[value], __LINE__, __FILE__);
+            --expected_value;
+        }
+        assertBool(std::ranges::equal(shuffled.rbegin(), shuffled.rend(),
+                                      ascending.begin(),
+                                      std::next(ascending.begin(), 1000)),
+                   __LINE__, __FILE__);
+    }
+};
+
+static MergeSortTest mergeSortTest;
+}  // namespace test
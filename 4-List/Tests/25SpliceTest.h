@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "../../Common/ContainerStats.h"
+#include "../List.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct SpliceTest {
+    using Allocator = container_stats::CountingAllocator<int>;
+
+    // Links have to hold up both ways
+    static auto check(const List<int, Allocator>& lst,
+                      const std::vector<int>& expected) -> void {
+        assertEqual(lst.size(), expected.size(), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(lst, expected), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(lst.rbegin(), lst.rend(),
+                                      expected.rbegin(), expected.rend()),
+                   __LINE__, __FILE__);
+    }
+
+    SpliceTest() {
+        container_stats::Stats stats;
+        List<int, Allocator> a({1, 2, 3}, Allocator(stats));
+        List<int, Allocator> b({4, 5, 6, 7}, Allocator(stats));
+        std::size_t allocations = stats.allocations;
+
+        // A whole list, into the middle
+        auto five = std::next(b.begin());
+        a.splice(std::next(a.begin()), b);
+        check(a, {1, 4, 5, 6, 7, 2, 3});
+        check(b, {});
+        assertEqual(*five, 5, __LINE__, __FILE__);
+
+        // One element, to the other list and within the same one
+        b.splice(b.end(), a, five);
+        check(a, {1, 4, 6, 7, 2, 3});
+        check(b, {5});
+        a.splice(a.begin(), a, std::prev(a.end()));
+        a.splice(a.end(), a, std::next(a.begin()));
+        a.splice(a.begin(), a, a.begin());
+        a.splice(std::next(a.begin()), a, a.begin());
+        check(a, {3, 4, 6, 7, 2, 1});
+
+        // A range, into an empty list, between lists and within one
+        List<int, Allocator> c{Allocator(stats)};
+        c.splice(c.end(), a, std::next(a.begin(), 2), std::prev(a.end()));
+        check(a, {3, 4, 1});
+        check(c, {6, 7, 2});
+        c.splice(std::next(c.begin()), b, b.begin(), b.end());
+        check(b, {});
+        check(c, {6, 5, 7, 2});
+        c.splice(c.begin(), c, std::next(c.begin(), 2), c.end());
+        check(c, {7, 2, 6, 5});
+        c.splice(c.begin(), c, c.begin(), std::next(c.begin(), 2));
+        check(c, {7, 2, 6, 5});
+        c.splice(c.begin(), a, a.begin(), a.begin());
+        check(c, {7, 2, 6, 5});
+        c.splice(c.end(), List<int, Allocator>({8, 9}, Allocator(stats)));
+        check(c, {7, 2, 6, 5, 8, 9});
+        assertEqual(stats.allocations, allocations + 2, __LINE__, __FILE__);
+
+        // Keeping the least recently used last, as an LRU cache does
+        List<int> lru;
+        std::unordered_map<int, List<int>::iterator> where;
+        for (int key = 0; key < 100; ++key) {
+            lru.push_front(key);
+            where[key] = lru.begin();
+        }
+        std::vector<int> expected(lru.begin(), lru.end());
+        std::mt19937 rng(25);
+        std::uniform_int_distribution<int> dist(0, 99);
+        for (int i = 0; i < 2000; ++i) {
+            int key = dist(rng);
+            lru.splice(lru.begin(), lru, where[key]);
+            std::erase(expected, key);
+            expected.insert(expected.begin(), key);
+        }
+        assertBool(std::ranges::equal(lru, expected), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(lru.rbegin(), lru.rend(),
+                                      expected.rbegin(), expected.rend()),
+                   __LINE__, __FILE__);
+    }
+};
+
+static SpliceTest spliceTest;
+}  // namespace test
@@ -0,0 +1,68 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../../Common/ContainerStats.h"
+#include "../List.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct MoveMergeTest {
+    MoveMergeTest() {
+        using Allocator = container_stats::CountingAllocator<int>;
+        container_stats::Stats stats;
+        List<int, Allocator> lst1({4, 6, 10, 20, 30, 34, 35}, Allocator(stats));
+        List<int, Allocator> lst2({1, 2, 3, 7, 40, 50}, Allocator(stats));
+        std::vector<int> expected{1, 2, 3, 4, 6, 7, 10, 20, 30, 34, 35, 40, 50};
+        const int* seven = &*std::next(lst2.begin(), 3);
+        std::size_t allocations = stats.allocations;
+
+        lst1.merge(std::move(lst2));
+        assertBool(std::ranges::equal(lst1, expected), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(lst1.rbegin(), lst1.rend(),
+                                      expected.rbegin(), expected.rend()),
+                   __LINE__, __FILE__);
+        assertBool(lst2.empty(), __LINE__, __FILE__);
+        assertBool(&*std::next(lst1.begin(), 5) == seven, __LINE__, __FILE__);
+        assertEqual(stats.allocations, allocations, __LINE__, __FILE__);
+
+        // Into and from an empty list, and with itself
+        lst2.merge(std::move(lst1));
+        assertBool(std::ranges::equal(lst2, expected), __LINE__, __FILE__);
+        assertBool(lst1.empty(), __LINE__, __FILE__);
+        lst2.merge(std::move(lst1));
+        lst2.merge(std::move(lst2));
+        assertBool(std::ranges::equal(lst2, expected), __LINE__, __FILE__);
+        lst2.push_back(60);
+        assertEqual(lst2.back(), 60, __LINE__, __FILE__);
+
+        // Equal keys: ours first, then theirs, each in their own order
+        std::mt19937 rng(26);
+        std::uniform_int_distribution<int> dist(0, 30);
+        std::vector<std::pair<int, int>> ours;
+        std::vector<std::pair<int, int>> theirs;
+        for (int i = 0; i < 500; ++i) {
+            ours.push_back({dist(rng), i});
+            theirs.push_back({dist(rng), 1000 + i});
+        }
+        auto by_key_descending = [](const auto& a, const auto& b) {
+            return a.first > b.first;
+        };
+        std::ranges::stable_sort(ours, by_key_descending);
+        std::ranges::stable_sort(theirs, by_key_descending);
+        List<std::pair<int, int>> mine(ours.begin(), ours.end());
+        List<std::pair<int, int>> his(theirs.begin(), theirs.end());
+
+        std::vector<std::pair<int, int>> merged;
+        std::ranges::merge(ours, theirs, std::back_inserter(merged),
+                           by_key_descending);
+        mine.merge(std::move(his), by_key_descending);
+        assertBool(std::ranges::equal(mine, merged), __LINE__, __FILE__);
+        assertBool(his.empty(), __LINE__, __FILE__);
+    }
+};
+
+static MoveMergeTest moveMergeTest;
+}  // namespace test
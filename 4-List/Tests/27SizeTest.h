@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <list>
+#include <random>
+#include <utility>
+#include "../List.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct SizeTest {
+    static auto check(const List<int>& lst, const std::list<int>& expected)
+        -> void {
+        assertEqual(lst.size(), expected.size(), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(lst, expected), __LINE__, __FILE__);
+    }
+
+    // The count has to follow every way of adding and removing nodes,
+    // checked against std::list doing the same
+    SizeTest() {
+        List<int> a;
+        List<int> b{1, 2, 3};
+        std::list<int> expected_a;
+        std::list<int> expected_b{1, 2, 3};
+        std::mt19937 rng(27);
+        std::uniform_int_distribution<int> dist(0, 99);
+
+        for (int i = 0; i < 3000; ++i) {
+            int action = dist(rng) % 10;
+            int value = dist(rng);
+            auto somewhere = [&](std::size_t size) -> std::size_t {
+                return size == 0 ? 0 : dist(rng) % size;
+            };
+            std::size_t at_a = somewhere(expected_a.size());
+            std::size_t at_b = somewhere(expected_b.size());
+            auto pos_a = std::next(a.begin(), at_a);
+            auto exp_a = std::next(expected_a.begin(), at_a);
+            auto pos_b = std::next(b.begin(), at_b);
+            auto exp_b = std::next(expected_b.begin(), at_b);
+
+            if (action < 3) {
+                a.insert(pos_a, value);
+                expected_a.insert(exp_a, value);
+            } else if (action < 5 && !expected_a.empty()) {
+                a.erase(pos_a);
+                expected_a.erase(exp_a);
+            } else if (action == 5) {
+                b.push_back(value);
+                b.push_front(value);
+                expected_b.push_back(value);
+                expected_b.push_front(value);
+            } else if (action == 6 && !expected_b.empty()) {
+                a.splice(pos_a, b, pos_b);
+                expected_a.splice(exp_a, expected_b, exp_b);
+            } else if (action == 7) {
+                a.splice(pos_a, b, pos_b, b.end());
+                expected_a.splice(exp_a, expected_b, exp_b, expected_b.end());
+            } else if (action == 8) {
+                a.splice(a.begin(), a, pos_a, a.end());
+                expected_a.splice(expected_a.begin(), expected_a, exp_a,
+                                  expected_a.end());
+                b.splice(b.end(), a);
+                expected_b.splice(expected_b.end(), expected_a);
+            } else if (i % 50 == 9) {
+                a.sort();
+                b.sort();
+                expected_a.sort();
+                expected_b.sort();
+                a.merge(std::move(b));
+                expected_a.merge(expected_b);
+            } else if (i % 100 == 19) {
+                a.sort();
+                b.sort();
+                expected_a.sort();
+                expected_b.sort();
+                b.merge(a);
+                std::list<int> copy = expected_a;
+                expected_b.merge(copy);
+                a.clear();
+                expected_a.clear();
+            }
+            check(a, expected_a);
+            check(b, expected_b);
+        }
+
+        List<int> copy = b;
+        assertEqual(copy.size(), b.size(), __LINE__, __FILE__);
+        copy = a;
+        assertEqual(copy.size(), a.size(), __LINE__, __FILE__);
+    }
+};
+
+static SizeTest sizeTest;
+}  // namespace test
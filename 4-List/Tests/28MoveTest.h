@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../../Common/ContainerStats.h"
+#include "../../Common/NodeAllocators.h"
+#include "../List.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct MoveTest {
+    struct CopyCounter {
+        static inline std::size_t copies = 0;
+        int value;
+
+        CopyCounter(int value) : value(value) {}
+        CopyCounter(const CopyCounter& other) : value(other.value) {
+            ++copies;
+        }
+        CopyCounter(CopyCounter&& other) noexcept : value(other.value) {}
+        auto operator=(const CopyCounter& other) -> CopyCounter& {
+            value = other.value;
+            ++copies;
+            return *this;
+        }
+        auto operator=(CopyCounter&& other) noexcept -> CopyCounter& {
+            value = other.value;
+            return *this;
+        }
+    };
+
+    static auto make(int n) -> List<std::string> {
+        List<std::string> lst;
+        for (int i = 0; i < n; ++i) {
+            lst.push_back(std::to_string(i));
+        }
+        return lst;
+    }
+
+    static auto check(const List<std::string>& lst, int n) -> void {
+        assertEqual(lst.size(), std::size_t(n), __LINE__, __FILE__);
+        int i = n;
+        for (auto it = lst.rbegin(); it != lst.rend(); ++it) {
+            assertBool(*it == std::to_string(--i), __LINE__, __FILE__);
+        }
+        assertEqual(i, 0, __LINE__, __FILE__);
+    }
+
+    MoveTest() {
+        static_assert(std::is_nothrow_move_constructible_v<List<int>>);
+        static_assert(std::is_nothrow_move_assignable_v<List<int>>);
+
+        // Moving keeps the nodes, so their addresses, and empties the source
+        List<std::string> a = make(10);
+        const std::string* third = &*std::next(a.begin(), 2);
+        List<std::string> b = std::move(a);
+        check(b, 10);
+        check(a, 0);
+        assertBool(&*std::next(b.begin(), 2) == third, __LINE__, __FILE__);
+        a.push_back("again");
+        assertEqual(a.size(), 1u, __LINE__, __FILE__);
+
+        b = make(3);
+        check(b, 3);
+        b = std::move(a);
+        assertEqual(b.size(), 1u, __LINE__, __FILE__);
+        assertBool(b.front() == "again", __LINE__, __FILE__);
+        b = std::move(b);
+        assertEqual(b.size(), 1u, __LINE__, __FILE__);
+        List<std::string> empty;
+        List<std::string> moved_empty = std::move(empty);
+        check(moved_empty, 0);
+        moved_empty.push_front("x");
+        check(empty, 0);
+
+        // Moving allocates nothing, and old nodes are freed
+        container_stats::Stats stats;
+        using Allocator = container_stats::CountingAllocator<int>;
+        List<int, Allocator> counted({1, 2, 3}, Allocator(stats));
+        List<int, Allocator> target({4, 5}, Allocator(stats));
+        List<int, Allocator> moved = std::move(counted);
+        target = std::move(moved);
+        assertEqual(stats.allocations, 5u, __LINE__, __FILE__);
+        assertEqual(stats.live_blocks, 3, __LINE__, __FILE__);
+        assertBool(std::ranges::equal(target, std::vector{1, 2, 3}), __LINE__,
+                   __FILE__);
+
+        // Between pools the nodes can't change hands, the elements do
+        NodePool pool1;
+        NodePool pool2;
+        List<int, PoolAllocator<int>> in1({1, 2, 3}, PoolAllocator<int>(pool1));
+        List<int, PoolAllocator<int>> in2({4}, PoolAllocator<int>(pool2));
+        in2 = std::move(in1);
+        assertBool(std::ranges::equal(in2, std::vector{1, 2, 3}), __LINE__,
+                   __FILE__);
+        assertBool(in1.empty(), __LINE__, __FILE__);
+        assertEqual(in1.size(), 0u, __LINE__, __FILE__);
+        in1.push_back(7);
+        assertEqual(in1.back(), 7, __LINE__, __FILE__);
+
+        // Inserting an rvalue moves it in
+        List<std::string> strings;
+        std::string text(100, 'a');
+        strings.push_back(std::move(text));
+        assertBool(text.empty(), __LINE__, __FILE__);
+        text.assign(100, 'b');
+        strings.push_front(std::move(text));
+        assertBool(text.empty(), __LINE__, __FILE__);
+        text.assign(100, 'c');
+        strings.insert(std::next(strings.begin()), std::move(text));
+        assertBool(text.empty(), __LINE__, __FILE__);
+        strings.emplace_back(3, 'd');
+        strings.emplace_front(3, 'e');
+        assertBool(std::ranges::equal(
+                       strings, std::vector<std::string>{
+                                    "eee", std::string(100, 'b'),
+                                    std::string(100, 'c'),
+                                    std::string(100, 'a'), "ddd"}),
+                   __LINE__, __FILE__);
+
+        CopyCounter::copies = 0;
+        List<CopyCounter> counters;
+        for (int i = 0; i < 10; ++i) {
+            counters.push_back(CopyCounter(i));
+            counters.push_front(CopyCounter(i));
+            counters.insert(counters.begin(), CopyCounter(i));
+            counters.emplace_back(i);
+        }
+        List<CopyCounter> others = std::move(counters);
+        counters = std::move(others);
+        assertEqual(counters.size(), 40u, __LINE__, __FILE__);
+        assertEqual(CopyCounter::copies, 0u, __LINE__, __FILE__);
+    }
+};
+
+static MoveTest moveTest;
+}  // namespace test
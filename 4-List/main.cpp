@@ -23,6 +23,12 @@
 #include "Tests/20MergeTest.h"
 #include "Tests/21SortTest.h"
 #include "Tests/22StlCompatibilityTest.h"
+#include "Tests/23AllocatorTest.h"
+#include "Tests/24MergeSortTest.h"
+#include "Tests/25SpliceTest.h"
+#include "Tests/26MoveMergeTest.h"
+#include "Tests/27SizeTest.h"
+#include "Tests/28MoveTest.h"
 
 #include <iostream>
 
@@ -0,0 +1,1930 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FrozenSet.h"
+#include "KeySearch.h"
+#include "SetAlgebra.h"
+
+// B+-tree with the same interface as the AVL `Set`.
+// Keys live only in the leaves, which are linked together for iteration.
+// Nodes span a few cache lines and are searched with SIMD compares
+// (see KeySearch.h), so a lookup misses cache once per level
+// of a tree that is several times shallower than the AVL one.
+// Unlike with `Set`, insertions and erasures invalidate iterators.
+//
+// Keys are ints unless told otherwise. Key has to be default constructible,
+// the nodes hold arrays of them.
+template <typename Key = int,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<Key>>
+class BTreeSet {
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
+    BTreeSet();
+    explicit BTreeSet(const Compare& comp, const Alloc& alloc = Alloc());
+    BTreeSet(const BTreeSet& other);
+    auto operator=(const BTreeSet& other) -> BTreeSet&;
+    // Moving takes the nodes over and leaves `other` empty
+    BTreeSet(BTreeSet&& other) noexcept;
+    auto operator=(BTreeSet&& other) noexcept(moves_nodes) -> BTreeSet&;
+    ~BTreeSet();
+
+    BTreeSet(std::initializer_list<Key> list);
+
+    // Packs the leaves bottom-up in O(n) if the range is sorted,
+    // otherwise sorts it first. Duplicates are dropped.
+    template <std::input_iterator It, std::sentinel_for<It> Sn>
+        requires std::convertible_to<std::iter_value_t<It>, Key>
+    BTreeSet(It begin, Sn end);
+    template <std::input_iterator It, std::sentinel_for<It> Sn>
+        requires std::convertible_to<std::iter_value_t<It>, Key>
+    auto assign(It begin, Sn end) -> void;
+
+    auto operator==(const BTreeSet& other) const -> bool;
+
+    class iterator;
+    auto begin() const -> iterator;
+    auto end() const -> iterator;
+
+    auto size() const -> size_t;
+    auto empty() const -> bool;
+    auto key_comp() const -> Compare;
+    auto get_allocator() const -> Alloc;
+
+    auto insert(const Key& value) -> std::pair<iterator, bool>;
+    auto insert(Key&& value) -> std::pair<iterator, bool>;
+    // In amortized O(1) if `value` goes right before `hint` or right after
+    // it, like insert(value) otherwise. Returns where `value` is either way.
+    auto insert(iterator hint, const Key& value) -> iterator;
+    auto insert(iterator hint, Key&& value) -> iterator;
+    auto erase(const Key& value) -> size_t;
+    auto erase(iterator it) -> iterator;
+    // Cuts the range out of the tree and joins the two sides back together,
+    // in O(log n + k) for k keys erased
+    auto erase(iterator first, iterator last) -> iterator;
+    // Erases the keys in [lo, hi) and returns how many there were
+    auto erase_range(const Key& lo, const Key& hi) -> size_t;
+
+    // Moves the keys not less than `key` into the set returned. The tree is
+    // cut along one path in O(log n), and the leaves of the smaller side
+    // are walked to count its keys.
+    auto split(const Key& key) -> BTreeSet;
+    // Moves every key of `other` into this set, leaving `other` empty.
+    // If all of them go before or after this set's keys, the two trees are
+    // joined in O(log n). Otherwise the smaller set is moved into the
+    // larger one, in amortized O(1) per key.
+    auto join(BTreeSet&& other) -> void;
+
+    auto contains(const Key& value) const -> bool;
+    auto find(const Key& value) const -> iterator;
+    auto upper_bound(const Key& value) const -> iterator;
+    auto lower_bound(const Key& value) const -> iterator;
+
+    // Heterogeneous versions of the lookups above
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto contains(const K& value) const -> bool;
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto find(const K& value) const -> iterator;
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto upper_bound(const K& value) const -> iterator;
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto lower_bound(const K& value) const -> iterator;
+
+    // Look up every key of `keys` and write each answer to the same position
+    // of `out`, which must be at least as long.
+    // A batch of lookups descends level by level together, prefetching
+    // the nodes of the next level, so their cache misses overlap.
+    auto contains_many(std::span<const Key> keys, std::span<bool> out) const
+        -> void;
+    auto find_many(std::span<const Key> keys, std::span<iterator> out) const
+        -> void;
+
+    // Copies the values in [from, to] into `out`, as many as fit,
+    // and returns how many were copied.
+    // If `out` fills up, scan again starting after the last one copied.
+    auto scan(const Key& from, const Key& to, std::span<Key> out) const
+        -> size_t;
+
+    // A read-only copy laid out for the fastest lookups,
+    // for when the set is done changing
+    auto freeze() const -> FrozenSet<Key, Compare, FrozenLayout::eytzinger>
+        requires std::is_trivially_copyable_v<Key>;
+
+    // New sets made of the keys in either set, in both, or only in `a`.
+    // Large inputs are cut into key ranges that are merged in parallel.
+    friend auto set_union(const BTreeSet& a, const BTreeSet& b) -> BTreeSet {
+        return combine(a, b, set_algebra::Operation::set_union);
+    }
+    friend auto set_intersection(const BTreeSet& a, const BTreeSet& b)
+        -> BTreeSet {
+        return combine(a, b, set_algebra::Operation::intersection);
+    }
+    friend auto set_difference(const BTreeSet& a, const BTreeSet& b)
+        -> BTreeSet {
+        return combine(a, b, set_algebra::Operation::difference);
+    }
+
+    auto dump_graphviz(std::ostream& os) -> void;
+
+  private:
+    struct Node;
+    struct Leaf;
+    struct Inner;
+    struct Split;
+    struct Tree;
+
+    // Whether move assignment can always take the other set's nodes
+    static constexpr bool moves_nodes =
+        std::allocator_traits<
+            Alloc>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Alloc>::is_always_equal::value;
+
+    Node* root;
+    size_t height;  // number of inner levels above the leaves
+    // The rightmost leaf, for hints at end(), or null until one looks it up.
+    // Splitting or merging it keeps it up to date, bigger changes reset it.
+    Leaf* last_leaf;
+    size_t element_count;
+    [[no_unique_address]]
+    Compare comp;
+    [[no_unique_address]]
+    Alloc alloc;
+
+    template <typename K>
+    auto find_leaf(const K& value) const -> const Leaf*;
+    template <typename K>
+    auto find_key(const K& value) const -> iterator;
+    template <typename K>
+    auto upper_bound_key(const K& value) const -> iterator;
+    template <typename K>
+    auto lower_bound_key(const K& value) const -> iterator;
+    template <typename F>
+    auto lookup_many(std::span<const Key> keys, F&& found) const -> void;
+
+    auto assign_values(std::vector<Key> values) -> void;
+    auto split_keys(size_t count) const -> std::vector<Key>;
+    static auto combine(const BTreeSet& a,
+                        const BTreeSet& b,
+                        set_algebra::Operation op) -> BTreeSet;
+    static auto merged(const BTreeSet& a,
+                       const BTreeSet& b,
+                       set_algebra::Operation op) -> BTreeSet;
+    static auto edited(const BTreeSet& a,
+                       const BTreeSet& b,
+                       set_algebra::Operation op) -> BTreeSet;
+
+    static auto min_count(size_t height) -> int;
+
+    template <typename N>
+    auto new_node() -> N*;
+    template <typename N>
+    auto copy_node(const N& other) -> N*;
+    template <typename N>
+    auto delete_node(N* node) -> void;
+
+    auto rec_copy(const Node* from, size_t height, Leaf*& prev_leaf) -> Node*;
+    auto rec_destroy(Node* node, size_t height) -> void;
+    template <typename V>
+    auto insert_value(V&& value) -> std::pair<iterator, bool>;
+    template <typename V>
+    auto insert_hinted(iterator hint, V&& value) -> iterator;
+    template <typename V>
+    auto rec_insert(Node* node,
+                    size_t height,
+                    V&& value,
+                    std::pair<iterator, bool>& inserted) -> Split;
+    template <typename V>
+    auto leaf_insert(Leaf* leaf,
+                     V&& value,
+                     std::pair<iterator, bool>& inserted) -> Split;
+    auto inner_insert(Inner* inner, int at, Split split) -> Split;
+    auto rec_erase(Node* node, size_t height, const Key& value) -> bool;
+    // Erases the keys from `lo` up to `hi`, or to the end if that's null
+    auto erase_from(const Key& lo, const Key* hi) -> size_t;
+
+    static auto leftmost_leaf(Tree tree) -> Leaf*;
+    static auto rightmost_leaf(Tree tree) -> Leaf*;
+    auto split_tree(Tree tree, const Key& key) -> std::pair<Tree, Tree>;
+    auto rec_split(Tree tree, const Key& key) -> std::pair<Tree, Tree>;
+    auto concat(Tree left, Tree right) -> Tree;
+    auto join_trees(Tree left, Key separator, Tree right) -> Tree;
+    auto join_right(Inner* inner, size_t height, Key& separator, Tree right)
+        -> Split;
+    auto join_left(Inner* inner, size_t height, Key& separator, Tree left)
+        -> Split;
+    auto even_out(Node* left, Key& separator, Node* right, size_t height)
+        -> bool;
+
+    auto rebalance(Inner* parent, int at, size_t child_height) -> void;
+    static auto borrow_from_left(Inner* parent, int at, size_t child_height)
+        -> void;
+    static auto borrow_from_right(Inner* parent, int at, size_t child_height)
+        -> void;
+    auto merge(Inner* parent, int at, size_t child_height) -> void;
+
+    static auto rec_dump_graphviz(const Node* node,
+                                  size_t height,
+                                  std::ostream& os,
+                                  size_t& next_id) -> size_t;
+};
+
+template <typename Key, typename Compare, typename Alloc>
+struct BTreeSet<Key, Compare, Alloc>::Node {
+    int count = 0;
+};
+
+// A leaf fills four cache lines and an inner node eight,
+// with as many keys as fit but never fewer than four
+template <typename Key, typename Compare, typename Alloc>
+struct alignas(64) BTreeSet<Key, Compare, Alloc>::Leaf : Node {
+    static constexpr int capacity =
+        std::max<int>(4, (256 - 2 * sizeof(void*)) / sizeof(Key));
+    static constexpr int min_count = capacity / 2;
+
+    Leaf* next = nullptr;
+    Key keys[capacity]{};
+};
+
+// Child `i` holds the keys in [keys[i - 1], keys[i])
+template <typename Key, typename Compare, typename Alloc>
+struct alignas(64) BTreeSet<Key, Compare, Alloc>::Inner : Node {
+    static constexpr int capacity = std::max<int>(
+        4, (512 - 2 * sizeof(void*)) / (sizeof(Key) + sizeof(void*)));
+    static constexpr int min_count = capacity / 2;
+
+    Key keys[capacity]{};
+    Node* children[capacity + 1]{};
+};
+
+template <typename Key, typename Compare, typename Alloc>
+struct BTreeSet<Key, Compare, Alloc>::Split {
+    Node* right = nullptr;  // new right sibling, if the node had to split
+    Key separator{};        // smallest key under `right`
+};
+
+// A tree of its own, or a part cut out of one, with null for no keys
+template <typename Key, typename Compare, typename Alloc>
+struct BTreeSet<Key, Compare, Alloc>::Tree {
+    Node* root = nullptr;
+    size_t height = 0;
+};
+
+template <typename Key, typename Compare, typename Alloc>
+class BTreeSet<Key, Compare, Alloc>::iterator {
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = const Key;
+
+    iterator();
+    auto operator==(const iterator& other) const -> bool;
+    auto operator++() -> iterator&;    // Prefix
+    auto operator++(int) -> iterator;  // Postfix
+    auto operator*() const -> const Key&;
+    auto operator->() const -> const Key*;
+
+  private:
+    friend class BTreeSet;
+
+    const Leaf* leaf;
+    int slot;
+
+    // Moves a position one past the end of a leaf to the next leaf
+    iterator(const Leaf* leaf, int slot);
+};
+static_assert(std::forward_iterator<BTreeSet<>::iterator>);
+
+template <std::input_iterator It, std::sentinel_for<It> Sn>
+BTreeSet(It, Sn) -> BTreeSet<std::iter_value_t<It>>;
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::min_count(size_t height) -> int {
+    return height == 0 ? Leaf::min_count : Inner::min_count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename N>
+auto BTreeSet<Key, Compare, Alloc>::new_node() -> N* {
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<N>;
+    NodeAlloc node_alloc(alloc);
+
+    N* node = std::allocator_traits<NodeAlloc>::allocate(node_alloc, 1);
+    std::allocator_traits<NodeAlloc>::construct(node_alloc, node);
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename N>
+auto BTreeSet<Key, Compare, Alloc>::copy_node(const N& other) -> N* {
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<N>;
+    NodeAlloc node_alloc(alloc);
+
+    N* node = std::allocator_traits<NodeAlloc>::allocate(node_alloc, 1);
+    std::allocator_traits<NodeAlloc>::construct(node_alloc, node, other);
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename N>
+auto BTreeSet<Key, Compare, Alloc>::delete_node(N* node) -> void {
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<N>;
+    NodeAlloc node_alloc(alloc);
+
+    std::allocator_traits<NodeAlloc>::destroy(node_alloc, node);
+    std::allocator_traits<NodeAlloc>::deallocate(node_alloc, node, 1);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::BTreeSet() : BTreeSet(Compare()) {}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::BTreeSet(const Compare& comp,
+                                        const Alloc& alloc)
+    : root(nullptr),
+      height(0),
+      last_leaf(nullptr),
+      element_count(0),
+      comp(comp),
+      alloc(alloc) {
+    // four and eight cache lines
+    static_assert(!std::same_as<Key, int> ||
+                  (sizeof(Leaf) == 256 && sizeof(Inner) == 512));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rec_copy(const Node* from,
+                                             size_t height,
+                                             Leaf*& prev_leaf) -> Node* {
+    if (height == 0) {
+        Leaf* leaf = copy_node(*static_cast<const Leaf*>(from));
+        leaf->next = nullptr;
+        if (prev_leaf != nullptr) {
+            prev_leaf->next = leaf;
+        }
+        prev_leaf = leaf;
+        return leaf;
+    }
+
+    Inner* inner = copy_node(*static_cast<const Inner*>(from));
+    for (int i = 0; i <= inner->count; ++i) {
+        inner->children[i] =
+            rec_copy(inner->children[i], height - 1, prev_leaf);
+    }
+    return inner;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::BTreeSet(const BTreeSet& other)
+    : root(nullptr),
+      height(other.height),
+      last_leaf(nullptr),
+      element_count(other.element_count),
+      comp(other.comp),
+      alloc(other.alloc) {
+    if (other.root != nullptr) {
+        root = rec_copy(other.root, height, last_leaf);
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::operator=(const BTreeSet& other)
+    -> BTreeSet& {
+    if (&other == this) {
+        return *this;
+    }
+
+    if (root != nullptr) {
+        rec_destroy(root, height);
+        root = nullptr;
+    }
+
+    height = other.height;
+    element_count = other.element_count;
+    comp = other.comp;
+
+    last_leaf = nullptr;
+    if (other.root != nullptr) {
+        root = rec_copy(other.root, height, last_leaf);
+    }
+
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rec_destroy(Node* node, size_t height)
+    -> void {
+    if (height == 0) {
+        delete_node(static_cast<Leaf*>(node));
+        return;
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    for (int i = 0; i <= inner->count; ++i) {
+        rec_destroy(inner->children[i], height - 1);
+    }
+    delete_node(inner);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::BTreeSet(BTreeSet&& other) noexcept
+    : root(std::exchange(other.root, nullptr)),
+      height(std::exchange(other.height, 0)),
+      last_leaf(std::exchange(other.last_leaf, nullptr)),
+      element_count(std::exchange(other.element_count, 0)),
+      comp(other.comp),
+      alloc(other.alloc) {}
+
+// With an allocator that can't free the other set's nodes, they're copied
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::operator=(BTreeSet&& other) noexcept(
+    moves_nodes) -> BTreeSet& {
+    if (&other == this) {
+        return *this;
+    }
+    if (!moves_nodes && !(alloc == other.alloc)) {
+        *this = other;
+        other = BTreeSet(other.comp, other.alloc);
+        return *this;
+    }
+
+    if (root != nullptr) {
+        rec_destroy(root, height);
+    }
+    if constexpr (std::allocator_traits<
+                      Alloc>::propagate_on_container_move_assignment::value) {
+        alloc = other.alloc;
+    }
+    root = std::exchange(other.root, nullptr);
+    height = std::exchange(other.height, 0);
+    last_leaf = std::exchange(other.last_leaf, nullptr);
+    element_count = std::exchange(other.element_count, 0);
+    comp = other.comp;
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::~BTreeSet() {
+    if (root != nullptr) {
+        rec_destroy(root, height);
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::BTreeSet(std::initializer_list<Key> list)
+    : BTreeSet(list.begin(), list.end()) {}
+
+template <typename Key, typename Compare, typename Alloc>
+template <std::input_iterator It, std::sentinel_for<It> Sn>
+    requires std::convertible_to<std::iter_value_t<It>, Key>
+BTreeSet<Key, Compare, Alloc>::BTreeSet(It begin, Sn end) : BTreeSet() {
+    assign(begin, end);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <std::input_iterator It, std::sentinel_for<It> Sn>
+    requires std::convertible_to<std::iter_value_t<It>, Key>
+auto BTreeSet<Key, Compare, Alloc>::assign(It begin, Sn end) -> void {
+    std::vector<Key> values;
+    if constexpr (std::sized_sentinel_for<Sn, It>) {
+        values.reserve(end - begin);
+    }
+    for (; begin != end; ++begin) {
+        values.push_back(*begin);
+    }
+    assign_values(std::move(values));
+}
+
+// Every level is split into as few nodes as fit, with the entries spread
+// evenly between them, so each node ends up at least half full
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::assign_values(std::vector<Key> values)
+    -> void {
+    if (!std::ranges::is_sorted(values, comp)) {
+        std::ranges::sort(values, comp);
+    }
+    auto duplicates = std::ranges::unique(
+        values, [&](const Key& a, const Key& b) { return !comp(a, b); });
+    values.erase(duplicates.begin(), duplicates.end());
+
+    if (root != nullptr) {
+        rec_destroy(root, height);
+        root = nullptr;
+    }
+    height = 0;
+    last_leaf = nullptr;
+    element_count = values.size();
+
+    if (values.empty()) {
+        return;
+    }
+
+    size_t n = values.size();
+    size_t leaf_count = (n + Leaf::capacity - 1) / Leaf::capacity;
+
+    std::vector<Node*> level;
+    std::vector<Key> level_mins;  // smallest key under each node of `level`
+    Leaf* prev_leaf = nullptr;
+
+    for (size_t i = 0; i < leaf_count; ++i) {
+        size_t from = n * i / leaf_count;
+        size_t to = n * (i + 1) / leaf_count;
+
+        Leaf* leaf = new_node<Leaf>();
+        std::move(values.begin() + from, values.begin() + to, leaf->keys);
+        leaf->count = to - from;
+
+        if (prev_leaf != nullptr) {
+            prev_leaf->next = leaf;
+        }
+        prev_leaf = leaf;
+
+        level.push_back(leaf);
+        level_mins.push_back(leaf->keys[0]);
+    }
+
+    while (level.size() > 1) {
+        size_t m = level.size();
+        size_t inner_count = (m + Inner::capacity) / (Inner::capacity + 1);
+
+        std::vector<Node*> parents;
+        std::vector<Key> parent_mins;
+
+        for (size_t i = 0; i < inner_count; ++i) {
+            size_t from = m * i / inner_count;
+            size_t to = m * (i + 1) / inner_count;
+
+            Inner* inner = new_node<Inner>();
+            inner->count = to - from - 1;
+            for (size_t j = from; j < to; ++j) {
+                inner->children[j - from] = level[j];
+                if (j > from) {
+                    inner->keys[j - from - 1] = std::move(level_mins[j]);
+                }
+            }
+
+            parents.push_back(inner);
+            parent_mins.push_back(std::move(level_mins[from]));
+        }
+
+        level = std::move(parents);
+        level_mins = std::move(parent_mins);
+        height++;
+    }
+
+    root = level[0];
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::operator==(const BTreeSet& other) const
+    -> bool {
+    return std::ranges::equal(*this, other);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::size() const -> size_t {
+    return element_count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::empty() const -> bool {
+    return element_count == 0;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::key_comp() const -> Compare {
+    return comp;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::get_allocator() const -> Alloc {
+    return alloc;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto BTreeSet<Key, Compare, Alloc>::leaf_insert(
+    Leaf* leaf,
+    V&& value,
+    std::pair<iterator, bool>& inserted) -> Split {
+    int pos = key_search::count_less(leaf->keys, leaf->count, value, comp);
+
+    if (pos < leaf->count && !comp(value, leaf->keys[pos])) {
+        inserted = {iterator(leaf, pos), false};
+        return {};
+    }
+
+    Split split;
+    Leaf* target = leaf;
+
+    if (leaf->count == Leaf::capacity) {
+        // upper half goes to a new right sibling
+        Leaf* right = new_node<Leaf>();
+        int mid = Leaf::capacity / 2;
+
+        std::move(leaf->keys + mid, leaf->keys + leaf->count, right->keys);
+        right->count = leaf->count - mid;
+        leaf->count = mid;
+
+        right->next = leaf->next;
+        leaf->next = right;
+        if (leaf == last_leaf) {
+            last_leaf = right;
+        }
+
+        if (pos > mid) {
+            target = right;
+            pos -= mid;
+        }
+
+        split.right = right;
+    }
+
+    std::move_backward(target->keys + pos, target->keys + target->count,
+                       target->keys + target->count + 1);
+    target->keys[pos] = std::forward<V>(value);
+    target->count++;
+
+    if (split.right != nullptr) {
+        split.separator = static_cast<Leaf*>(split.right)->keys[0];
+    }
+
+    inserted = {iterator(target, pos), true};
+    return split;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::inner_insert(Inner* inner,
+                                                 int at,
+                                                 Split split) -> Split {
+    if (inner->count < Inner::capacity) {
+        std::move_backward(inner->keys + at, inner->keys + inner->count,
+                           inner->keys + inner->count + 1);
+        std::copy_backward(inner->children + at + 1,
+                           inner->children + inner->count + 1,
+                           inner->children + inner->count + 2);
+        inner->keys[at] = std::move(split.separator);
+        inner->children[at + 1] = split.right;
+        inner->count++;
+        return {};
+    }
+
+    // Lay out the overfull node in scratch space, then split it in two
+    // around the middle key, which moves up to the parent
+    Key keys[Inner::capacity + 1];
+    Node* children[Inner::capacity + 2];
+
+    std::move(inner->keys, inner->keys + at, keys);
+    keys[at] = std::move(split.separator);
+    std::move(inner->keys + at, inner->keys + inner->count, keys + at + 1);
+
+    std::copy(inner->children, inner->children + at + 1, children);
+    children[at + 1] = split.right;
+    std::copy(inner->children + at + 1, inner->children + inner->count + 1,
+              children + at + 2);
+
+    int total = Inner::capacity + 1;
+    int mid = total / 2;
+
+    Inner* right = new_node<Inner>();
+
+    inner->count = mid;
+    std::move(keys, keys + mid, inner->keys);
+    std::copy(children, children + mid + 1, inner->children);
+
+    right->count = total - mid - 1;
+    std::move(keys + mid + 1, keys + total, right->keys);
+    std::copy(children + mid + 1, children + total + 1, right->children);
+
+    return {right, std::move(keys[mid])};
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto BTreeSet<Key, Compare, Alloc>::rec_insert(
+    Node* node,
+    size_t height,
+    V&& value,
+    std::pair<iterator, bool>& inserted) -> Split {
+    if (height == 0) {
+        return leaf_insert(static_cast<Leaf*>(node), std::forward<V>(value),
+                           inserted);
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    int at =
+        key_search::count_less_equal(inner->keys, inner->count, value, comp);
+
+    Split split = rec_insert(inner->children[at], height - 1,
+                             std::forward<V>(value), inserted);
+
+    if (split.right == nullptr) {
+        return {};
+    }
+
+    return inner_insert(inner, at, std::move(split));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::insert(const Key& value)
+    -> std::pair<iterator, bool> {
+    return insert_value(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::insert(Key&& value)
+    -> std::pair<iterator, bool> {
+    return insert_value(std::move(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto BTreeSet<Key, Compare, Alloc>::insert_value(V&& value)
+    -> std::pair<iterator, bool> {
+    if (root == nullptr) {
+        root = new_node<Leaf>();
+        height = 0;
+    }
+
+    std::pair<iterator, bool> inserted;
+    Split split = rec_insert(root, height, std::forward<V>(value), inserted);
+
+    if (split.right != nullptr) {
+        Inner* new_root = new_node<Inner>();
+        new_root->count = 1;
+        new_root->keys[0] = std::move(split.separator);
+        new_root->children[0] = root;
+        new_root->children[1] = split.right;
+
+        root = new_root;
+        height++;
+    }
+
+    if (inserted.second) {
+        element_count++;
+    }
+
+    return inserted;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::insert(iterator hint, const Key& value)
+    -> iterator {
+    return insert_hinted(hint, value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::insert(iterator hint, Key&& value)
+    -> iterator {
+    return insert_hinted(hint, std::move(value));
+}
+
+// Skips the descent when `value` lands strictly between two keys of the
+// hint's leaf, or after the last key of the last leaf: nothing above the
+// leaf can change then. A full leaf, or a spot at a leaf's edge, where
+// the value might belong to the neighbour, goes the usual way.
+// Hints at end() look the last leaf up once, and again only after
+// something other than an insertion or erasure reshaped the tree.
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto BTreeSet<Key, Compare, Alloc>::insert_hinted(iterator hint, V&& value)
+    -> iterator {
+    Leaf* leaf = const_cast<Leaf*>(hint.leaf);
+    int slot = hint.slot;
+
+    // end() has no leaf, it's past the last key of the rightmost one
+    if (leaf == nullptr && root != nullptr) {
+        if (last_leaf == nullptr) {
+            last_leaf = rightmost_leaf({root, height});
+        }
+        leaf = last_leaf;
+        slot = leaf->count;
+    }
+
+    // A hint to the key before `value`, like the last one inserted,
+    // is as good as one to the key after it
+    if (leaf != nullptr && slot < leaf->count &&
+        comp(leaf->keys[slot], value)) {
+        slot++;
+    }
+
+    if (leaf == nullptr || leaf->count == Leaf::capacity || slot == 0 ||
+        !comp(leaf->keys[slot - 1], value) ||
+        (slot < leaf->count ? !comp(value, leaf->keys[slot])
+                            : leaf->next != nullptr)) {
+        return insert_value(std::forward<V>(value)).first;
+    }
+
+    std::move_backward(leaf->keys + slot, leaf->keys + leaf->count,
+                       leaf->keys + leaf->count + 1);
+    leaf->keys[slot] = std::forward<V>(value);
+    leaf->count++;
+    element_count++;
+
+    return iterator(leaf, slot);
+}
+
+// |                                                         |
+// |     [ .. a | c .. ]             [ .. b | c .. ]         |
+// |      /    |                      /    |                 |
+// |  [.. b]  [d ..]   -------->  [..]   [b d ..]            |
+// |                                                         |
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::borrow_from_left(Inner* parent,
+                                                     int at,
+                                                     size_t child_height)
+    -> void {
+    Node* child = parent->children[at];
+    Node* left = parent->children[at - 1];
+
+    if (child_height == 0) {
+        Leaf* leaf = static_cast<Leaf*>(child);
+        Leaf* donor = static_cast<Leaf*>(left);
+
+        std::move_backward(leaf->keys, leaf->keys + leaf->count,
+                           leaf->keys + leaf->count + 1);
+        leaf->keys[0] = std::move(donor->keys[donor->count - 1]);
+
+        parent->keys[at - 1] = leaf->keys[0];
+    } else {
+        Inner* inner = static_cast<Inner*>(child);
+        Inner* donor = static_cast<Inner*>(left);
+
+        std::move_backward(inner->keys, inner->keys + inner->count,
+                           inner->keys + inner->count + 1);
+        std::copy_backward(inner->children, inner->children + inner->count + 1,
+                           inner->children + inner->count + 2);
+        inner->keys[0] = std::move(parent->keys[at - 1]);
+        inner->children[0] = donor->children[donor->count];
+
+        parent->keys[at - 1] = std::move(donor->keys[donor->count - 1]);
+    }
+
+    left->count--;
+    child->count++;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::borrow_from_right(Inner* parent,
+                                                      int at,
+                                                      size_t child_height)
+    -> void {
+    Node* child = parent->children[at];
+    Node* right = parent->children[at + 1];
+
+    if (child_height == 0) {
+        Leaf* leaf = static_cast<Leaf*>(child);
+        Leaf* donor = static_cast<Leaf*>(right);
+
+        leaf->keys[leaf->count] = std::move(donor->keys[0]);
+        std::move(donor->keys + 1, donor->keys + donor->count, donor->keys);
+
+        parent->keys[at] = donor->keys[0];
+    } else {
+        Inner* inner = static_cast<Inner*>(child);
+        Inner* donor = static_cast<Inner*>(right);
+
+        inner->keys[inner->count] = std::move(parent->keys[at]);
+        inner->children[inner->count + 1] = donor->children[0];
+
+        parent->keys[at] = std::move(donor->keys[0]);
+
+        std::move(donor->keys + 1, donor->keys + donor->count, donor->keys);
+        std::copy(donor->children + 1, donor->children + donor->count + 1,
+                  donor->children);
+    }
+
+    right->count--;
+    child->count++;
+}
+
+// Folds children[at + 1] into children[at]
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::merge(Inner* parent,
+                                          int at,
+                                          size_t child_height) -> void {
+    Node* left = parent->children[at];
+    Node* right = parent->children[at + 1];
+
+    if (child_height == 0) {
+        Leaf* into = static_cast<Leaf*>(left);
+        Leaf* from = static_cast<Leaf*>(right);
+
+        std::move(from->keys, from->keys + from->count,
+                  into->keys + into->count);
+        into->count += from->count;
+        into->next = from->next;
+        if (from == last_leaf) {
+            last_leaf = into;
+        }
+
+        delete_node(from);
+    } else {
+        Inner* into = static_cast<Inner*>(left);
+        Inner* from = static_cast<Inner*>(right);
+
+        into->keys[into->count] = std::move(parent->keys[at]);
+        std::move(from->keys, from->keys + from->count,
+                  into->keys + into->count + 1);
+        std::copy(from->children, from->children + from->count + 1,
+                  into->children + into->count + 1);
+        into->count += from->count + 1;
+
+        delete_node(from);
+    }
+
+    std::move(parent->keys + at + 1, parent->keys + parent->count,
+              parent->keys + at);
+    std::copy(parent->children + at + 2, parent->children + parent->count + 1,
+              parent->children + at + 1);
+    parent->count--;
+}
+
+// Brings an underfull children[at] back to the minimum occupancy
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rebalance(Inner* parent,
+                                              int at,
+                                              size_t child_height) -> void {
+    int min = min_count(child_height);
+
+    if (at > 0 && parent->children[at - 1]->count > min) {
+        borrow_from_left(parent, at, child_height);
+    } else if (at < parent->count && parent->children[at + 1]->count > min) {
+        borrow_from_right(parent, at, child_height);
+    } else if (at > 0) {
+        merge(parent, at - 1, child_height);
+    } else {
+        merge(parent, at, child_height);
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rec_erase(Node* node,
+                                              size_t height,
+                                              const Key& value) -> bool {
+    if (height == 0) {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        int pos = key_search::count_less(leaf->keys, leaf->count, value, comp);
+
+        if (pos == leaf->count || comp(value, leaf->keys[pos])) {
+            return false;
+        }
+
+        std::move(leaf->keys + pos + 1, leaf->keys + leaf->count,
+                  leaf->keys + pos);
+        leaf->count--;
+        return true;
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    int at =
+        key_search::count_less_equal(inner->keys, inner->count, value, comp);
+
+    if (!rec_erase(inner->children[at], height - 1, value)) {
+        return false;
+    }
+
+    if (inner->children[at]->count < min_count(height - 1)) {
+        rebalance(inner, at, height - 1);
+    }
+
+    return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::erase(const Key& value) -> size_t {
+    if (root == nullptr || !rec_erase(root, height, value)) {
+        return 0;
+    }
+
+    element_count--;
+
+    if (height > 0 && root->count == 0) {
+        Inner* old_root = static_cast<Inner*>(root);
+        root = old_root->children[0];
+        height--;
+        delete_node(old_root);
+    } else if (height == 0 && root->count == 0) {
+        delete_node(static_cast<Leaf*>(root));
+        root = nullptr;
+        last_leaf = nullptr;
+    }
+
+    return 1;
+}
+
+// A leaf that stays full enough is the only node touched. Otherwise the
+// path down to it is found from the key erased, to rebalance along it.
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::erase(iterator it) -> iterator {
+    Leaf* leaf = const_cast<Leaf*>(it.leaf);
+    int slot = it.slot;
+    element_count--;
+
+    if (height == 0 || leaf->count > Leaf::min_count) {
+        std::move(leaf->keys + slot + 1, leaf->keys + leaf->count,
+                  leaf->keys + slot);
+        leaf->count--;
+
+        if (leaf->count == 0) {  // only the root can run out of keys
+            delete_node(leaf);
+            root = nullptr;
+            last_leaf = nullptr;
+            return end();
+        }
+        return iterator(leaf, slot);
+    }
+
+    // A tree 64 levels high would hold more keys than fit in memory
+    std::array<std::pair<Inner*, int>, 64> path;
+    Node* node = root;
+    for (size_t level = height; level > 0; --level) {
+        Inner* inner = static_cast<Inner*>(node);
+        int at = key_search::count_less_equal(inner->keys, inner->count,
+                                              leaf->keys[slot], comp);
+        path[level - 1] = {inner, at};
+        node = inner->children[at];
+    }
+    assert(node == leaf);
+
+    std::move(leaf->keys + slot + 1, leaf->keys + leaf->count,
+              leaf->keys + slot);
+    leaf->count--;
+
+    // Same steps as rebalance(), keeping track of where the next key goes
+    auto [parent, at] = path[0];
+    int min = Leaf::min_count;
+    if (at > 0 && parent->children[at - 1]->count > min) {
+        borrow_from_left(parent, at, 0);
+        slot++;
+    } else if (at < parent->count && parent->children[at + 1]->count > min) {
+        borrow_from_right(parent, at, 0);
+    } else if (at > 0) {
+        Leaf* left = static_cast<Leaf*>(parent->children[at - 1]);
+        slot += left->count;
+        merge(parent, at - 1, 0);
+        leaf = left;
+    } else {
+        merge(parent, at, 0);
+    }
+
+    for (size_t level = 1; level < height; ++level) {
+        auto [above, child] = path[level];
+        if (above->children[child]->count >= Inner::min_count) {
+            break;
+        }
+        rebalance(above, child, level);
+    }
+
+    if (root->count == 0) {
+        Inner* old_root = static_cast<Inner*>(root);
+        root = old_root->children[0];
+        height--;
+        delete_node(old_root);
+    }
+
+    return iterator(leaf, slot);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::erase(iterator first, iterator last)
+    -> iterator {
+    if (first == last) {
+        return last;
+    }
+
+    // cutting moves keys around, so hold on to copies of the bounds
+    Key lo = *first;
+    if (last == end()) {
+        erase_from(lo, nullptr);
+        return end();
+    }
+
+    Key hi = *last;
+    erase_from(lo, &hi);
+    return lower_bound(hi);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::erase_range(const Key& lo, const Key& hi)
+    -> size_t {
+    if (!comp(lo, hi)) {
+        return 0;
+    }
+
+    Key from = lo;
+    Key to = hi;
+    return erase_from(from, &to);
+}
+
+// The range is cut out as a tree of its own, which is freed a leaf at a
+// time, and the parts on either side of it are joined back together
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::erase_from(const Key& lo, const Key* hi)
+    -> size_t {
+    auto [before, doomed] = split_tree({root, height}, lo);
+    Tree after;
+    if (hi != nullptr) {
+        std::tie(doomed, after) = split_tree(doomed, *hi);
+    }
+
+    size_t erased = 0;
+    for (const Leaf* leaf = leftmost_leaf(doomed); leaf != nullptr;
+         leaf = leaf->next) {
+        erased += leaf->count;
+    }
+    if (doomed.root != nullptr) {
+        rec_destroy(doomed.root, doomed.height);
+    }
+
+    Tree kept = concat(before, after);
+    root = kept.root;
+    height = kept.height;
+    last_leaf = nullptr;
+    element_count -= erased;
+    return erased;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::leftmost_leaf(Tree tree) -> Leaf* {
+    if (tree.root == nullptr) {
+        return nullptr;
+    }
+
+    Node* node = tree.root;
+    for (size_t level = tree.height; level > 0; --level) {
+        node = static_cast<Inner*>(node)->children[0];
+    }
+    return static_cast<Leaf*>(node);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rightmost_leaf(Tree tree) -> Leaf* {
+    if (tree.root == nullptr) {
+        return nullptr;
+    }
+
+    Node* node = tree.root;
+    for (size_t level = tree.height; level > 0; --level) {
+        Inner* inner = static_cast<Inner*>(node);
+        node = inner->children[inner->count];
+    }
+    return static_cast<Leaf*>(node);
+}
+
+// Cuts `tree` into the keys less than `key` and the rest, in O(log n)
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::split_tree(Tree tree, const Key& key)
+    -> std::pair<Tree, Tree> {
+    if (tree.root == nullptr) {
+        return {};
+    }
+
+    // the leaves stay chained across the cut until both parts are whole
+    auto parts = rec_split(tree, key);
+    if (parts.first.root != nullptr) {
+        rightmost_leaf(parts.first)->next = nullptr;
+    }
+    return parts;
+}
+
+// The node on the path falls apart into the children left of the cut and
+// the ones right of it, and each side joins the part cut out below it.
+// A join costs the difference in height of its two trees, which adds up
+// to O(log n) along the path.
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rec_split(Tree tree, const Key& key)
+    -> std::pair<Tree, Tree> {
+    if (tree.height == 0) {
+        Leaf* leaf = static_cast<Leaf*>(tree.root);
+        int pos = key_search::count_less(leaf->keys, leaf->count, key, comp);
+
+        if (pos == 0) {
+            return {Tree(), tree};
+        }
+        if (pos == leaf->count) {
+            return {tree, Tree()};
+        }
+
+        Leaf* right = new_node<Leaf>();
+        std::move(leaf->keys + pos, leaf->keys + leaf->count, right->keys);
+        right->count = leaf->count - pos;
+        leaf->count = pos;
+        right->next = leaf->next;
+        leaf->next = right;
+        return {tree, {right, 0}};
+    }
+
+    Inner* inner = static_cast<Inner*>(tree.root);
+    size_t below = tree.height - 1;
+    int at =
+        key_search::count_less_equal(inner->keys, inner->count, key, comp);
+    auto [mid_left, mid_right] = rec_split({inner->children[at], below}, key);
+
+    Tree left;
+    Tree right;
+    Key left_separator{};
+    Key right_separator{};
+    if (at > 0) {
+        left_separator = std::move(inner->keys[at - 1]);
+    }
+    if (at < inner->count) {
+        right_separator = std::move(inner->keys[at]);
+    }
+
+    // The node goes on as a side that keeps two children or more, and a
+    // side left with one is just that child
+    int right_count = inner->count - at - 1;
+    Inner* right_part = inner;
+    if (at > 1) {
+        inner->count = at - 1;
+        left = tree;
+        right_part = right_count > 0 ? new_node<Inner>() : nullptr;
+    } else if (at == 1) {
+        left = {inner->children[0], below};
+    }
+
+    if (right_count == 0) {
+        right = {inner->children[at + 1], below};
+    } else if (right_count > 0) {
+        std::move(inner->keys + at + 1, inner->keys + at + 1 + right_count,
+                  right_part->keys);
+        std::copy(inner->children + at + 1,
+                  inner->children + at + 2 + right_count,
+                  right_part->children);
+        right_part->count = right_count;
+        right = {right_part, tree.height};
+    }
+
+    if (at <= 1 && right_count <= 0) {
+        delete_node(inner);
+    }
+
+    return {join_trees(left, std::move(left_separator), mid_left),
+            join_trees(mid_right, std::move(right_separator), right)};
+}
+
+// Joins two trees whose leaves aren't chained together yet
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::concat(Tree left, Tree right) -> Tree {
+    if (left.root == nullptr) {
+        return right;
+    }
+    if (right.root == nullptr) {
+        return left;
+    }
+
+    Leaf* first = leftmost_leaf(right);
+    rightmost_leaf(left)->next = first;
+    return join_trees(left, first->keys[0], right);
+}
+
+// Every key of `left` is less than `separator`, which is no greater than
+// any key of `right`, and the leaves of the two are chained already.
+// The shorter tree goes in at its own height on the side of the other.
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::join_trees(Tree left,
+                                               Key separator,
+                                               Tree right) -> Tree {
+    if (left.root == nullptr) {
+        return right;
+    }
+    if (right.root == nullptr) {
+        return left;
+    }
+
+    Tree tall;
+    Split split;
+    if (left.height == right.height) {
+        if (even_out(left.root, separator, right.root, left.height)) {
+            return left;
+        }
+        tall = left;
+        split = {right.root, std::move(separator)};
+    } else if (left.height > right.height) {
+        tall = left;
+        split = join_right(static_cast<Inner*>(left.root), left.height,
+                           separator, right);
+    } else {
+        tall = right;
+        split = join_left(static_cast<Inner*>(right.root), right.height,
+                          separator, left);
+    }
+
+    if (split.right == nullptr) {
+        return tall;
+    }
+
+    Inner* new_root = new_node<Inner>();
+    new_root->count = 1;
+    new_root->keys[0] = std::move(split.separator);
+    new_root->children[0] = tall.root;
+    new_root->children[1] = split.right;
+    return {new_root, tall.height + 1};
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::join_right(Inner* inner,
+                                               size_t height,
+                                               Key& separator,
+                                               Tree right) -> Split {
+    Node* last = inner->children[inner->count];
+
+    if (height == right.height + 1) {
+        if (even_out(last, separator, right.root, right.height)) {
+            return {};
+        }
+        return inner_insert(inner, inner->count,
+                            {right.root, std::move(separator)});
+    }
+
+    Split split = join_right(static_cast<Inner*>(last), height - 1,
+                             separator, right);
+    if (split.right == nullptr) {
+        return {};
+    }
+    return inner_insert(inner, inner->count, std::move(split));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::join_left(Inner* inner,
+                                              size_t height,
+                                              Key& separator,
+                                              Tree left) -> Split {
+    Node* first = inner->children[0];
+
+    if (height == left.height + 1) {
+        bool merged = even_out(left.root, separator, first, left.height);
+        inner->children[0] = left.root;
+        if (merged) {
+            return {};
+        }
+        return inner_insert(inner, 0, {first, std::move(separator)});
+    }
+
+    Split split = join_left(static_cast<Inner*>(first), height - 1,
+                            separator, left);
+    if (split.right == nullptr) {
+        return {};
+    }
+    return inner_insert(inner, 0, std::move(split));
+}
+
+// Brings two neighbours of the same height, either of which may be the
+// root of a tree and short of keys, up to the minimum occupancy. Returns
+// whether that took folding `right` into `left`, and otherwise leaves in
+// `separator` the key that now goes between them.
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::even_out(Node* left,
+                                             Key& separator,
+                                             Node* right,
+                                             size_t height) -> bool {
+    int min = min_count(height);
+    if (left->count >= min && right->count >= min) {
+        return false;
+    }
+
+    // a parent in scratch space, so the borrows and the merge apply as is
+    Inner parent;
+    parent.count = 1;
+    parent.keys[0] = std::move(separator);
+    parent.children[0] = left;
+    parent.children[1] = right;
+
+    while (left->count < min && right->count > min) {
+        borrow_from_right(&parent, 0, height);
+    }
+    while (right->count < min && left->count > min) {
+        borrow_from_left(&parent, 1, height);
+    }
+
+    if (left->count < min || right->count < min) {
+        merge(&parent, 0, height);
+        return true;
+    }
+
+    separator = std::move(parent.keys[0]);
+    return false;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::split(const Key& key) -> BTreeSet {
+    BTreeSet result(comp, alloc);
+
+    Key from = key;
+    auto [less, rest] = split_tree({root, height}, from);
+    root = less.root;
+    height = less.height;
+    last_leaf = nullptr;
+    result.root = rest.root;
+    result.height = rest.height;
+
+    // Walking both sides a leaf at a time stops once the smaller is counted
+    size_t less_count = 0;
+    size_t rest_count = 0;
+    const Leaf* a = leftmost_leaf(less);
+    const Leaf* b = leftmost_leaf(rest);
+    while (a != nullptr && b != nullptr) {
+        less_count += a->count;
+        rest_count += b->count;
+        a = a->next;
+        b = b->next;
+    }
+
+    result.element_count =
+        a == nullptr ? element_count - less_count : rest_count;
+    element_count -= result.element_count;
+    return result;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::join(BTreeSet&& other) -> void {
+    if (&other == this || other.empty()) {
+        return;
+    }
+
+    if (alloc == other.alloc) {
+        Tree self{root, height};
+        Tree added{other.root, other.height};
+        Tree joined;
+
+        if (empty()) {
+            joined = added;
+        } else {
+            const Leaf* last = rightmost_leaf(self);
+            const Leaf* other_last = rightmost_leaf(added);
+
+            if (comp(last->keys[last->count - 1], *other.begin())) {
+                joined = concat(self, added);
+            } else if (comp(other_last->keys[other_last->count - 1],
+                            *begin())) {
+                joined = concat(added, self);
+            }
+        }
+
+        if (joined.root != nullptr) {
+            root = joined.root;
+            height = joined.height;
+            last_leaf = nullptr;
+            element_count += other.element_count;
+            other.root = nullptr;
+            other.height = 0;
+            other.last_leaf = nullptr;
+            other.element_count = 0;
+            return;
+        }
+
+        if (other.size() > size()) {
+            std::swap(root, other.root);
+            std::swap(height, other.height);
+            std::swap(last_leaf, other.last_leaf);
+            std::swap(element_count, other.element_count);
+        }
+    }
+
+    // Each key goes right before the one after the last inserted,
+    // which is where it belongs unless the two sets interleave
+    iterator hint = lower_bound(*other.begin());
+    for (const Key& key : other) {
+        hint = std::next(insert(hint, key));
+    }
+
+    other.assign_values({});
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto BTreeSet<Key, Compare, Alloc>::find_leaf(const K& value) const
+    -> const Leaf* {
+    const Node* node = root;
+
+    for (size_t level = height; level > 0; --level) {
+        const Inner* inner = static_cast<const Inner*>(node);
+        int at = key_search::count_less_equal(inner->keys, inner->count,
+                                              value, comp);
+        node = inner->children[at];
+    }
+
+    return static_cast<const Leaf*>(node);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto BTreeSet<Key, Compare, Alloc>::find_key(const K& value) const
+    -> iterator {
+    if (root == nullptr) {
+        return end();
+    }
+
+    const Leaf* leaf = find_leaf(value);
+    int pos = key_search::count_less(leaf->keys, leaf->count, value, comp);
+
+    if (pos < leaf->count && !comp(value, leaf->keys[pos])) {
+        return iterator(leaf, pos);
+    }
+
+    return end();
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto BTreeSet<Key, Compare, Alloc>::upper_bound_key(const K& value) const
+    -> iterator {
+    if (root == nullptr) {
+        return end();
+    }
+
+    const Leaf* leaf = find_leaf(value);
+    return iterator(leaf, key_search::count_less_equal(
+                              leaf->keys, leaf->count, value, comp));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto BTreeSet<Key, Compare, Alloc>::lower_bound_key(const K& value) const
+    -> iterator {
+    if (root == nullptr) {
+        return end();
+    }
+
+    const Leaf* leaf = find_leaf(value);
+    return iterator(
+        leaf, key_search::count_less(leaf->keys, leaf->count, value, comp));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::contains(const Key& value) const -> bool {
+    return find_key(value) != end();
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::find(const Key& value) const -> iterator {
+    return find_key(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::upper_bound(const Key& value) const
+    -> iterator {
+    return upper_bound_key(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::lower_bound(const Key& value) const
+    -> iterator {
+    return lower_bound_key(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto BTreeSet<Key, Compare, Alloc>::contains(const K& value) const -> bool {
+    return find_key(value) != end();
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto BTreeSet<Key, Compare, Alloc>::find(const K& value) const -> iterator {
+    return find_key(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto BTreeSet<Key, Compare, Alloc>::upper_bound(const K& value) const
+    -> iterator {
+    return upper_bound_key(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto BTreeSet<Key, Compare, Alloc>::lower_bound(const K& value) const
+    -> iterator {
+    return lower_bound_key(value);
+}
+
+// Every leaf is at the same depth, so a batch of lookups can descend
+// in lockstep: while one level's nodes are searched, the next level's
+// are already on their way from memory.
+// Calls found(i, leaf, slot) for the i-th key, with a null leaf for a miss.
+template <typename Key, typename Compare, typename Alloc>
+template <typename F>
+auto BTreeSet<Key, Compare, Alloc>::lookup_many(std::span<const Key> keys,
+                                                F&& found) const -> void {
+    constexpr size_t lanes = 16;
+    std::array<const Node*, lanes> nodes;
+
+    if (root == nullptr) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            found(i, nullptr, 0);
+        }
+        return;
+    }
+
+    for (size_t first = 0; first < keys.size(); first += lanes) {
+        size_t batch = std::min(lanes, keys.size() - first);
+        nodes.fill(root);
+
+        for (size_t level = height; level > 0; --level) {
+            for (size_t lane = 0; lane < batch; ++lane) {
+                const Inner* inner = static_cast<const Inner*>(nodes[lane]);
+                int at = key_search::count_less_equal(
+                    inner->keys, inner->count, keys[first + lane], comp);
+                nodes[lane] = inner->children[at];
+
+                // the keys are in the first four cache lines of either kind
+                const char* bytes = reinterpret_cast<const char*>(nodes[lane]);
+                for (int line = 0; line < 4; ++line) {
+                    __builtin_prefetch(bytes + line * 64);
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < batch; ++lane) {
+            const Leaf* leaf = static_cast<const Leaf*>(nodes[lane]);
+            const Key& value = keys[first + lane];
+            int pos =
+                key_search::count_less(leaf->keys, leaf->count, value, comp);
+
+            if (pos < leaf->count && !comp(value, leaf->keys[pos])) {
+                found(first + lane, leaf, pos);
+            } else {
+                found(first + lane, nullptr, 0);
+            }
+        }
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::contains_many(std::span<const Key> keys,
+                                                  std::span<bool> out) const
+    -> void {
+    assert(out.size() >= keys.size());
+    lookup_many(keys, [&](size_t i, const Leaf* leaf, int) {
+        out[i] = leaf != nullptr;
+    });
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::find_many(std::span<const Key> keys,
+                                              std::span<iterator> out) const
+    -> void {
+    assert(out.size() >= keys.size());
+    lookup_many(keys, [&](size_t i, const Leaf* leaf, int slot) {
+        out[i] = leaf != nullptr ? iterator(leaf, slot) : end();
+    });
+}
+
+// Copies whole runs of keys leaf by leaf
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::scan(const Key& from,
+                                         const Key& to,
+                                         std::span<Key> out) const -> size_t {
+    if (comp(to, from)) {
+        return 0;
+    }
+
+    size_t count = 0;
+    iterator it = lower_bound(from);
+    const Leaf* leaf = it.leaf;
+    size_t slot = it.slot;
+
+    while (leaf != nullptr && count < out.size()) {
+        auto stop = static_cast<size_t>(
+            key_search::count_less_equal(leaf->keys, leaf->count, to, comp));
+        size_t n = std::min(stop - slot, out.size() - count);
+
+        std::copy(leaf->keys + slot, leaf->keys + slot + n,
+                  out.begin() + count);
+        count += n;
+
+        if (stop < static_cast<size_t>(leaf->count)) {
+            break;
+        }
+
+        leaf = leaf->next;
+        slot = 0;
+    }
+
+    return count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::freeze() const
+    -> FrozenSet<Key, Compare, FrozenLayout::eytzinger>
+    requires std::is_trivially_copyable_v<Key>
+{
+    return FrozenSet<Key, Compare, FrozenLayout::eytzinger>(*this, comp);
+}
+
+// Separators of the highest inner level that has enough of them
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::split_keys(size_t count) const
+    -> std::vector<Key> {
+    std::vector<Key> keys;
+    std::vector<const Node*> level{root};
+
+    for (size_t h = height; h > 0 && keys.size() < count; --h) {
+        std::vector<const Node*> children;
+        keys.clear();
+
+        for (const Node* node : level) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            keys.insert(keys.end(), inner->keys, inner->keys + inner->count);
+            children.insert(children.end(), inner->children,
+                            inner->children + inner->count + 1);
+        }
+
+        level = std::move(children);
+    }
+
+    return keys;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::combine(const BTreeSet& a,
+                                            const BTreeSet& b,
+                                            set_algebra::Operation op)
+    -> BTreeSet {
+    return set_algebra::by_edits(a, b, op)
+               ? edited(a, b, op)
+               : merged(a, b, op);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::edited(const BTreeSet& a,
+                                           const BTreeSet& b,
+                                           set_algebra::Operation op)
+    -> BTreeSet {
+    const BTreeSet& small = a.size() < b.size() ? a : b;
+    BTreeSet result = a.size() < b.size() ? b : a;
+    set_algebra::apply_edits(result, small, op);
+    return result;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::merged(const BTreeSet& a,
+                                           const BTreeSet& b,
+                                           set_algebra::Operation op)
+    -> BTreeSet {
+    BTreeSet result(a.comp, a.alloc);
+    result.assign_values(
+        set_algebra::combine(a, b, op, &BTreeSet::split_keys));
+    return result;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::rec_dump_graphviz(const Node* node,
+                                                      size_t height,
+                                                      std::ostream& os,
+                                                      size_t& next_id)
+    -> size_t {
+    size_t id = next_id++;
+    const Key* keys = height == 0 ? static_cast<const Leaf*>(node)->keys
+                                  : static_cast<const Inner*>(node)->keys;
+
+    os << std::format("  {} [shape=record, label=\"", id);
+    for (int i = 0; i < node->count; ++i) {
+        os << (i == 0 ? "" : "|") << keys[i];
+    }
+    os << "\"]\n";
+
+    if (height > 0) {
+        const Inner* inner = static_cast<const Inner*>(node);
+        for (int i = 0; i <= inner->count; ++i) {
+            size_t child_id =
+                rec_dump_graphviz(inner->children[i], height - 1, os, next_id);
+            os << std::format("  {} -> {}\n", id, child_id);
+        }
+    }
+
+    return id;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::dump_graphviz(std::ostream& os) -> void {
+    os << "digraph BTree {\n";
+    if (root != nullptr) {
+        size_t next_id = 0;
+        rec_dump_graphviz(root, height, os, next_id);
+    }
+    os << "}\n";
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::begin() const -> iterator {
+    if (root == nullptr) {
+        return end();
+    }
+
+    const Node* node = root;
+    for (size_t level = height; level > 0; --level) {
+        node = static_cast<const Inner*>(node)->children[0];
+    }
+
+    return iterator(static_cast<const Leaf*>(node), 0);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::end() const -> iterator {
+    return iterator();
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::iterator::iterator()
+    : leaf(nullptr), slot(0) {}
+
+template <typename Key, typename Compare, typename Alloc>
+BTreeSet<Key, Compare, Alloc>::iterator::iterator(const Leaf* leaf, int slot)
+    : leaf(leaf), slot(slot) {
+    if (slot == leaf->count) {
+        this->leaf = leaf->next;
+        this->slot = 0;
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::iterator::operator==(
+    const iterator& other) const -> bool = default;
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::iterator::operator++()
+    -> iterator& {  // Prefix
+    slot++;
+
+    if (slot == leaf->count) {
+        leaf = leaf->next;
+        slot = 0;
+    }
+
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::iterator::operator++(int)
+    -> iterator {  // Postfix
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::iterator::operator*() const
+    -> const Key& {
+    // supress clang-tidy warning about possible return of null reference
+    assert(leaf != nullptr);
+    return leaf->keys[slot];
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto BTreeSet<Key, Compare, Alloc>::iterator::operator->() const
+    -> const Key* {
+    return &leaf->keys[slot];
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto operator<<(std::ostream& os, const BTreeSet<Key, Compare, Alloc>& set)
+    -> std::ostream& {
+    auto begin = set.begin();
+    auto end = set.end();
+
+    os << '{';
+    if (begin != end) {
+        os << *begin;
+        ++begin;
+    }
+
+    while (begin != end) {
+        os << ", " << *begin;
+        ++begin;
+    }
+    os << '}';
+    return os;
+}
@@ -0,0 +1,598 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// AVL tree that many threads can read while another one updates it.
+// Nodes are never changed once other threads can see them: the writer
+// copies the path from the root down to the change, plus any node a
+// rotation touches, and then publishes the new root with one atomic store.
+// Until then the copies are its own, so rebalancing them again on the way
+// up changes them in place.
+// Lookups load the root and search that version of the tree without
+// taking any lock, so they never wait for the writer or for each other.
+//
+// The nodes a write replaces are freed later, in batches, once every
+// lookup that might still be reading them has finished. A writer never
+// waits for that: while old lookups are still running, it leaves the
+// batch for a later write to free.
+// Writers are serialized by a mutex, and are meant to be the rare case.
+template <typename Key = int,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<Key>>
+class ConcurrentSet {
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
+    ConcurrentSet();
+    explicit ConcurrentSet(const Compare& comp, const Alloc& alloc = Alloc());
+    ConcurrentSet(const ConcurrentSet& other) = delete;
+    auto operator=(const ConcurrentSet& other) -> ConcurrentSet& = delete;
+    ~ConcurrentSet();
+
+    ConcurrentSet(std::initializer_list<Key> list);
+
+    // Safe to call from any thread at any time, the writers below too,
+    // even from inside a for_each callback
+
+    auto size() const -> size_t;
+    auto empty() const -> bool;
+    auto key_comp() const -> Compare;
+    auto get_allocator() const -> Alloc;
+
+    auto contains(const Key& value) const -> bool;
+    // Lookups return a copy, the stored key may be freed right after
+    auto find(const Key& value) const -> std::optional<Key>;
+    auto lower_bound(const Key& value) const -> std::optional<Key>;
+    auto upper_bound(const Key& value) const -> std::optional<Key>;
+
+    // Calls f(key) on every key in order, all from the same version
+    template <typename F>
+    auto for_each(F&& f) const -> void;
+
+    // Serialized with each other, never block the lookups above
+
+    auto insert(const Key& value) -> bool;
+    auto erase(const Key& value) -> size_t;
+
+  private:
+    struct Node;
+    class ReadGuard;
+
+    // Counters of the lookups in progress, one pair per stripe so that
+    // readers on different threads mostly touch different cache lines
+    struct alignas(64) ReaderCounts {
+        std::array<std::atomic<size_t>, 2> by_epoch{};
+    };
+
+    static constexpr size_t stripes = 16;
+    // Replaced nodes wait until there are this many before being freed
+    static constexpr size_t reclaim_batch = 512;
+
+    std::atomic<const Node*> root;
+    std::atomic<size_t> element_count;
+    std::atomic<std::uint64_t> epoch;
+    mutable std::array<ReaderCounts, stripes> readers;
+
+    std::mutex writer;
+    std::vector<const Node*> retired;  // replaced since the last epoch
+    // Replaced before the last epoch, freed once its readers are gone
+    std::vector<const Node*> waiting;
+    std::vector<Node*> fresh;  // made by this write, not yet published
+    [[no_unique_address]]
+    Compare comp;
+    [[no_unique_address]]
+    Alloc alloc;
+
+    auto new_node(const Key& value, const Node* left, const Node* right)
+        -> const Node*;
+    auto delete_node(const Node* node) -> void;
+    auto rec_destroy(const Node* node) -> void;
+    auto publish(const Node* new_root) -> void;
+
+    auto retire(const Node* node) -> void;
+    auto readers_left(std::uint64_t of_epoch) const -> bool;
+    auto free_all(std::vector<const Node*>& nodes) -> void;
+    auto reclaim() -> void;
+    auto replace(const Node* node, const Node* left, const Node* right)
+        -> const Node*;
+
+    static auto level(const Node* node) -> int;
+    auto right_rotate(const Node* node) -> const Node*;
+    auto left_rotate(const Node* node) -> const Node*;
+    auto rebalance(const Node* node) -> const Node*;
+
+    auto rec_insert(const Node* node, const Key& value) -> const Node*;
+    auto rec_erase(const Node* node, const Key& value) -> const Node*;
+    auto rec_erase_min(const Node* node) -> const Node*;
+};
+
+template <typename Key, typename Compare, typename Alloc>
+struct ConcurrentSet<Key, Compare, Alloc>::Node {
+    Key value;
+    const Node* left;
+    const Node* right;
+    std::uint8_t level;
+    bool fresh;  // not yet reachable from the published root
+};
+
+// Counts the calling thread as reading during the current epoch.
+// The writer moves to the next epoch before freeing anything, and then
+// frees only once the lookups counted under the previous one finish.
+// A lookup that starts after the switch can only reach the newer root.
+template <typename Key, typename Compare, typename Alloc>
+class ConcurrentSet<Key, Compare, Alloc>::ReadGuard {
+  public:
+    explicit ReadGuard(const ConcurrentSet& set) {
+        static thread_local const size_t stripe =
+            std::hash<std::thread::id>()(std::this_thread::get_id()) %
+            stripes;
+
+        // If the epoch moved on in between, the writer may have already
+        // looked at this counter, so count again under the new epoch
+        while (true) {
+            std::uint64_t epoch = set.epoch.load();
+            counter = &set.readers[stripe].by_epoch[epoch % 2];
+            counter->fetch_add(1);
+            if (set.epoch.load() == epoch) {
+                break;
+            }
+            counter->fetch_sub(1);
+        }
+    }
+
+    ReadGuard(const ReadGuard& other) = delete;
+    auto operator=(const ReadGuard& other) -> ReadGuard& = delete;
+
+    ~ReadGuard() { counter->fetch_sub(1, std::memory_order_release); }
+
+  private:
+    std::atomic<size_t>* counter;
+};
+
+template <typename Key, typename Compare, typename Alloc>
+ConcurrentSet<Key, Compare, Alloc>::ConcurrentSet()
+    : ConcurrentSet(Compare()) {}
+
+template <typename Key, typename Compare, typename Alloc>
+ConcurrentSet<Key, Compare, Alloc>::ConcurrentSet(const Compare& comp,
+                                                  const Alloc& alloc)
+    : root(nullptr),
+      element_count(0),
+      epoch(0),
+      comp(comp),
+      alloc(alloc) {}
+
+template <typename Key, typename Compare, typename Alloc>
+ConcurrentSet<Key, Compare, Alloc>::ConcurrentSet(
+    std::initializer_list<Key> list)
+    : ConcurrentSet() {
+    for (const Key& value : list) {
+        insert(value);
+    }
+}
+
+// No lookups can be running any more, everything goes at once
+template <typename Key, typename Compare, typename Alloc>
+ConcurrentSet<Key, Compare, Alloc>::~ConcurrentSet() {
+    rec_destroy(root.load());
+    free_all(waiting);
+    free_all(retired);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::new_node(const Key& value,
+                                                  const Node* left,
+                                                  const Node* right)
+    -> const Node* {
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    NodeAlloc node_alloc(alloc);
+
+    Node* node = std::allocator_traits<NodeAlloc>::allocate(node_alloc, 1);
+    std::allocator_traits<NodeAlloc>::construct(
+        node_alloc, node, value, left, right,
+        static_cast<std::uint8_t>(1 + std::max(level(left), level(right))),
+        true);
+    fresh.push_back(node);
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::delete_node(const Node* node)
+    -> void {
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    NodeAlloc node_alloc(alloc);
+
+    Node* mutable_node = const_cast<Node*>(node);
+    std::allocator_traits<NodeAlloc>::destroy(node_alloc, mutable_node);
+    std::allocator_traits<NodeAlloc>::deallocate(node_alloc, mutable_node, 1);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::rec_destroy(const Node* node)
+    -> void {
+    if (node == nullptr) {
+        return;
+    }
+    rec_destroy(node->left);
+    rec_destroy(node->right);
+    delete_node(node);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::retire(const Node* node) -> void {
+    retired.push_back(node);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::readers_left(
+    std::uint64_t of_epoch) const -> bool {
+    return std::ranges::any_of(readers, [&](const ReaderCounts& stripe) {
+        return stripe.by_epoch[of_epoch % 2].load() != 0;
+    });
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::free_all(
+    std::vector<const Node*>& nodes) -> void {
+    for (const Node* node : nodes) {
+        delete_node(node);
+    }
+    nodes.clear();
+}
+
+// Everything retired so far was replaced before the latest root was
+// published, so once the readers of the current epoch are gone,
+// nobody can reach it any more. Moving to the next epoch lets them
+// be told apart from the lookups that start later. A lookup still
+// running doesn't hold up the writer, only this batch: the next
+// epoch waits for it to be freed, and the nodes retired meanwhile
+// pile up in `retired` until it is.
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::reclaim() -> void {
+    std::uint64_t current = epoch.load(std::memory_order_relaxed);
+    if (!waiting.empty()) {
+        if (readers_left(current - 1)) {
+            return;
+        }
+        free_all(waiting);
+    }
+
+    waiting.swap(retired);
+    epoch.store(current + 1);
+    if (!readers_left(current)) {
+        free_all(waiting);
+    }
+}
+
+// `node` with other children: a copy if other threads may see it,
+// and then the old one is retired
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::replace(const Node* node,
+                                                 const Node* left,
+                                                 const Node* right)
+    -> const Node* {
+    if (!node->fresh) {
+        retire(node);
+        return new_node(node->value, left, right);
+    }
+
+    Node* own = const_cast<Node*>(node);
+    own->left = left;
+    own->right = right;
+    own->level =
+        static_cast<std::uint8_t>(1 + std::max(level(left), level(right)));
+    return own;
+}
+
+// Nobody can change the nodes of this write once others may read them
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::publish(const Node* new_root)
+    -> void {
+    for (Node* node : fresh) {
+        node->fresh = false;
+    }
+    fresh.clear();
+    root.store(new_root, std::memory_order_release);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::level(const Node* node) -> int {
+    return node == nullptr ? 0 : node->level;
+}
+
+// Same rotations as in `Set`, except that both nodes involved are copied
+// unless this write made them
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::right_rotate(const Node* node)
+    -> const Node* {
+    const Node* left = node->left;
+    const Node* lowered = replace(node, left->right, node->right);
+    return replace(left, left->left, lowered);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::left_rotate(const Node* node)
+    -> const Node* {
+    const Node* right = node->right;
+    const Node* lowered = replace(node, node->left, right->left);
+    return replace(right, lowered, right->right);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::rebalance(const Node* node)
+    -> const Node* {
+    int balance = level(node->left) - level(node->right);
+
+    if (balance > 1) {
+        const Node* left = node->left;
+        if (level(left->left) < level(left->right)) {
+            node = replace(node, left_rotate(left), node->right);
+        }
+        return right_rotate(node);
+    }
+
+    if (balance < -1) {
+        const Node* right = node->right;
+        if (level(right->right) < level(right->left)) {
+            node = replace(node, node->left, right_rotate(right));
+        }
+        return left_rotate(node);
+    }
+
+    return node;
+}
+
+// Returns `node` itself if `value` is already there
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::rec_insert(const Node* node,
+                                                    const Key& value)
+    -> const Node* {
+    if (node == nullptr) {
+        return new_node(value, nullptr, nullptr);
+    }
+
+    if (comp(value, node->value)) {
+        const Node* left = rec_insert(node->left, value);
+        if (left == node->left) {
+            return node;
+        }
+        return rebalance(replace(node, left, node->right));
+    }
+
+    if (comp(node->value, value)) {
+        const Node* right = rec_insert(node->right, value);
+        if (right == node->right) {
+            return node;
+        }
+        return rebalance(replace(node, node->left, right));
+    }
+
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::rec_erase_min(const Node* node)
+    -> const Node* {
+    if (node->left == nullptr) {
+        retire(node);
+        return node->right;
+    }
+    return rebalance(
+        replace(node, rec_erase_min(node->left), node->right));
+}
+
+// Returns `node` itself if `value` isn't there
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::rec_erase(const Node* node,
+                                                   const Key& value)
+    -> const Node* {
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    if (comp(value, node->value)) {
+        const Node* left = rec_erase(node->left, value);
+        if (left == node->left) {
+            return node;
+        }
+        return rebalance(replace(node, left, node->right));
+    }
+
+    if (comp(node->value, value)) {
+        const Node* right = rec_erase(node->right, value);
+        if (right == node->right) {
+            return node;
+        }
+        return rebalance(replace(node, node->left, right));
+    }
+
+    retire(node);
+    if (node->left == nullptr) {
+        return node->right;
+    }
+    if (node->right == nullptr) {
+        return node->left;
+    }
+
+    // The successor takes the erased node's place.
+    // It's only retired, so it can still be read below.
+    const Node* successor = node->right;
+    while (successor->left != nullptr) {
+        successor = successor->left;
+    }
+    const Node* right = rec_erase_min(node->right);
+    return rebalance(new_node(successor->value, node->left, right));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::insert(const Key& value) -> bool {
+    std::lock_guard lock(writer);
+
+    const Node* old_root = root.load(std::memory_order_relaxed);
+    const Node* new_root = rec_insert(old_root, value);
+    if (new_root == old_root) {
+        return false;
+    }
+
+    publish(new_root);
+    element_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (retired.size() >= reclaim_batch) {
+        reclaim();
+    }
+    return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::erase(const Key& value) -> size_t {
+    std::lock_guard lock(writer);
+
+    const Node* old_root = root.load(std::memory_order_relaxed);
+    const Node* new_root = rec_erase(old_root, value);
+    if (new_root == old_root) {
+        return 0;
+    }
+
+    publish(new_root);
+    element_count.fetch_sub(1, std::memory_order_relaxed);
+
+    if (retired.size() >= reclaim_batch) {
+        reclaim();
+    }
+    return 1;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::size() const -> size_t {
+    return element_count.load(std::memory_order_relaxed);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::empty() const -> bool {
+    return size() == 0;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::key_comp() const -> Compare {
+    return comp;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::get_allocator() const -> Alloc {
+    return alloc;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::contains(const Key& value) const
+    -> bool {
+    ReadGuard guard(*this);
+    const Node* node = root.load(std::memory_order_acquire);
+
+    while (node != nullptr) {
+        bool less = comp(value, node->value);
+        bool greater = comp(node->value, value);
+
+        if (!(less | greater)) {
+            return true;
+        }
+        node = less ? node->left : node->right;
+    }
+
+    return false;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::find(const Key& value) const
+    -> std::optional<Key> {
+    ReadGuard guard(*this);
+    const Node* node = root.load(std::memory_order_acquire);
+
+    while (node != nullptr) {
+        bool less = comp(value, node->value);
+        bool greater = comp(node->value, value);
+
+        if (!(less | greater)) {
+            return node->value;
+        }
+        node = less ? node->left : node->right;
+    }
+
+    return std::nullopt;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::lower_bound(const Key& value) const
+    -> std::optional<Key> {
+    ReadGuard guard(*this);
+    const Node* node = root.load(std::memory_order_acquire);
+    const Node* bound = nullptr;
+
+    while (node != nullptr) {
+        if (!comp(node->value, value)) {
+            bound = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    return bound == nullptr ? std::nullopt : std::optional<Key>(bound->value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto ConcurrentSet<Key, Compare, Alloc>::upper_bound(const Key& value) const
+    -> std::optional<Key> {
+    ReadGuard guard(*this);
+    const Node* node = root.load(std::memory_order_acquire);
+    const Node* bound = nullptr;
+
+    while (node != nullptr) {
+        if (comp(value, node->value)) {
+            bound = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    return bound == nullptr ? std::nullopt : std::optional<Key>(bound->value);
+}
+
+// Holds back freeing the nodes replaced meanwhile for as long as it runs,
+// though not the writers
+template <typename Key, typename Compare, typename Alloc>
+template <typename F>
+auto ConcurrentSet<Key, Compare, Alloc>::for_each(F&& f) const -> void {
+    ReadGuard guard(*this);
+    std::vector<const Node*> path;
+    const Node* node = root.load(std::memory_order_acquire);
+
+    while (node != nullptr || !path.empty()) {
+        while (node != nullptr) {
+            path.push_back(node);
+            node = node->left;
+        }
+        node = path.back();
+        path.pop_back();
+        f(node->value);
+        node = node->right;
+    }
+}
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// How a FrozenSet orders its keys in memory, and in the file it's saved to
+enum class FrozenLayout : std::uint32_t {
+    // Ascending, searched by binary search
+    sorted = 0,
+    // In breadth-first order of a complete binary search tree, from 1:
+    // the children of keys[k] are keys[2k] and keys[2k + 1]. The first
+    // levels share a few cache lines, the descent needs no branches, and
+    // the next levels can be prefetched long before they're needed.
+    eytzinger = 1,
+};
+
+// Read-only set of keys in one array, which is also how it's saved:
+// a 64-byte header and then the keys exactly as they lie in memory.
+// Opening a saved set maps the file instead of reading it, so it's ready
+// at once whatever its size, and only the pages a search touches are ever
+// read from disk. Opening needs POSIX, so it's in FrozenSetFile.h, and
+// everything else here is portable.
+//
+// Keys have to be trivially copyable. Files keep the machine's byte order
+// and are meant to be read back on the same kind of machine; the header
+// catches a different key size, but not a different byte order.
+template <typename Key = int,
+          typename Compare = std::less<Key>,
+          FrozenLayout Layout = FrozenLayout::sorted>
+class FrozenSet {
+    static_assert(std::is_trivially_copyable_v<Key>,
+                  "FrozenSet stores keys as raw bytes");
+    static_assert(alignof(Key) <= 64, "keys are 64-byte aligned in the file");
+
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+
+    FrozenSet();
+    // Copies a set, or anything else that yields keys in ascending order
+    template <std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>, Key>
+    explicit FrozenSet(const R& sorted, const Compare& comp = Compare());
+    FrozenSet(const FrozenSet& other) = delete;
+    auto operator=(const FrozenSet& other) -> FrozenSet& = delete;
+    FrozenSet(FrozenSet&& other) noexcept;
+    auto operator=(FrozenSet&& other) noexcept -> FrozenSet&;
+    ~FrozenSet();
+
+    // Writes the keys of `sorted`, which must be ascending under Compare
+    template <std::ranges::sized_range R>
+    static auto save(const R& sorted, std::ostream& os) -> void;
+    auto save(std::ostream& os) const -> void;
+
+    // Maps a saved set read-only. The mapping outlives the file being
+    // deleted, but not the file being rewritten in place.
+    // Defined in FrozenSetFile.h.
+    static auto open(const std::string& path) -> FrozenSet;
+    // Reads a saved set into memory, for streams that aren't files
+    static auto load(std::istream& is) -> FrozenSet;
+
+    class iterator;
+    auto begin() const -> iterator;
+    auto end() const -> iterator;
+
+    auto size() const -> size_t;
+    auto empty() const -> bool;
+    auto key_comp() const -> Compare;
+
+    auto contains(const Key& value) const -> bool;
+    auto find(const Key& value) const -> iterator;
+    auto upper_bound(const Key& value) const -> iterator;
+    auto lower_bound(const Key& value) const -> iterator;
+
+  private:
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t key_size;
+        std::uint64_t count;
+        FrozenLayout layout;
+        char reserved[36];
+    };
+    static_assert(sizeof(Header) == 64);
+
+    static constexpr char magic[8] = {'D', 'S', 'F', 'R', 'O', 'Z', 'E', 'N'};
+    static constexpr std::uint32_t version = 1;
+
+    // The Eytzinger array leaves keys[0] unused, so that the children
+    // of k are at 2k and 2k + 1
+    static constexpr size_t unused_slots =
+        Layout == FrozenLayout::eytzinger ? 1 : 0;
+    // Descendants this many levels down fill one cache line together
+    static constexpr size_t prefetch_stride =
+        std::bit_floor(std::max<size_t>(1, 64 / sizeof(Key)));
+
+    std::vector<Key> owned;  // empty when the keys are mapped
+    const Key* keys;
+    size_t count;
+    void* mapping;
+    size_t mapping_size;
+    void (*unmap)(void* mapping, size_t size);  // set by open()
+    [[no_unique_address]]
+    Compare comp;
+
+    static auto make_header(size_t count) -> Header;
+    static auto check_header(const Header& header) -> void;
+    // Whether `count` keys fit in `bytes`, checked without multiplying
+    // out the count, which comes from the file and may be anything
+    static auto fits(std::uint64_t count, size_t bytes) -> bool;
+
+    // Positions in keys[] of the first and the next key in order
+    auto first_slot() const -> size_t;
+    auto next_slot(size_t slot) const -> size_t;
+    auto end_slot() const -> size_t;
+
+    template <typename GoesRight>
+    auto eytzinger_search(GoesRight goes_right) const -> size_t;
+};
+
+// The sorted Layout simply counts up. The Eytzinger one walks the
+// implicit tree in order: down to the leftmost key of the right subtree,
+// or else up past every ancestor it's the right child of.
+template <typename Key, typename Compare, FrozenLayout Layout>
+class FrozenSet<Key, Compare, Layout>::iterator {
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = Key;
+    using pointer = const Key*;
+    using reference = const Key&;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator() = default;
+
+    auto operator*() const -> const Key& { return set->keys[slot]; }
+    auto operator->() const -> const Key* { return &set->keys[slot]; }
+
+    auto operator++() -> iterator& {
+        slot = set->next_slot(slot);
+        return *this;
+    }
+
+    auto operator++(int) -> iterator {
+        iterator copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    auto operator==(const iterator& other) const -> bool {
+        return slot == other.slot;
+    }
+
+  private:
+    friend class FrozenSet;
+
+    const FrozenSet* set = nullptr;
+    size_t slot = 0;
+
+    iterator(const FrozenSet* set, size_t slot) : set(set), slot(slot) {}
+};
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+FrozenSet<Key, Compare, Layout>::FrozenSet()
+    : keys(nullptr),
+      count(0),
+      mapping(nullptr),
+      mapping_size(0),
+      unmap(nullptr),
+      comp(Compare()) {}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, Key>
+FrozenSet<Key, Compare, Layout>::FrozenSet(const R& sorted,
+                                           const Compare& comp)
+    : FrozenSet() {
+    this->comp = comp;
+
+    if constexpr (Layout == FrozenLayout::sorted) {
+        owned.assign(std::ranges::begin(sorted), std::ranges::end(sorted));
+        keys = owned.data();
+        count = owned.size();
+    } else {
+        // Visiting the slots in order places the sorted keys where they go
+        std::vector<Key> values(std::ranges::begin(sorted),
+                                std::ranges::end(sorted));
+        owned.resize(values.size() + unused_slots);
+        keys = owned.data();
+        count = values.size();
+
+        size_t slot = first_slot();
+        for (const Key& value : values) {
+            owned[slot] = value;
+            slot = next_slot(slot);
+        }
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+FrozenSet<Key, Compare, Layout>::FrozenSet(FrozenSet&& other) noexcept
+    : owned(std::move(other.owned)),
+      keys(std::exchange(other.keys, nullptr)),
+      count(std::exchange(other.count, 0)),
+      mapping(std::exchange(other.mapping, nullptr)),
+      mapping_size(std::exchange(other.mapping_size, 0)),
+      unmap(other.unmap),
+      comp(other.comp) {}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::operator=(FrozenSet&& other) noexcept
+    -> FrozenSet& {
+    if (this != &other) {
+        if (mapping != nullptr) {
+            unmap(mapping, mapping_size);
+        }
+        owned = std::move(other.owned);
+        keys = std::exchange(other.keys, nullptr);
+        count = std::exchange(other.count, 0);
+        mapping = std::exchange(other.mapping, nullptr);
+        mapping_size = std::exchange(other.mapping_size, 0);
+        unmap = other.unmap;
+        comp = other.comp;
+    }
+    return *this;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+FrozenSet<Key, Compare, Layout>::~FrozenSet() {
+    if (mapping != nullptr) {
+        unmap(mapping, mapping_size);
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::make_header(size_t count) -> Header {
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.key_size = sizeof(Key);
+    header.count = count;
+    header.layout = Layout;
+    return header;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::check_header(const Header& header)
+    -> void {
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("not a saved FrozenSet");
+    }
+    if (header.version != version) {
+        throw std::runtime_error("unsupported FrozenSet file version");
+    }
+    if (header.layout != Layout) {
+        throw std::runtime_error("FrozenSet file has another Layout");
+    }
+    if (header.key_size != sizeof(Key)) {
+        throw std::runtime_error("FrozenSet file has keys of another size");
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::fits(std::uint64_t count, size_t bytes)
+    -> bool {
+    size_t slots = bytes / sizeof(Key);
+    return count == 0 ||
+           (slots >= unused_slots && count <= slots - unused_slots);
+}
+
+// A sorted range streams straight out through a buffer,
+// any other Layout has to be built first
+template <typename Key, typename Compare, FrozenLayout Layout>
+template <std::ranges::sized_range R>
+auto FrozenSet<Key, Compare, Layout>::save(const R& sorted, std::ostream& os)
+    -> void {
+    if constexpr (Layout != FrozenLayout::sorted) {
+        FrozenSet(sorted).save(os);
+        return;
+    }
+
+    Header header = make_header(std::ranges::size(sorted));
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<Key> buffer;
+    buffer.reserve(4096);
+    auto flush = [&] {
+        os.write(reinterpret_cast<const char*>(buffer.data()),
+                 static_cast<std::streamsize>(buffer.size() * sizeof(Key)));
+        buffer.clear();
+    };
+    for (const Key& key : sorted) {
+        buffer.push_back(key);
+        if (buffer.size() == buffer.capacity()) {
+            flush();
+        }
+    }
+    flush();
+
+    if (!os) {
+        throw std::runtime_error("failed to write FrozenSet");
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::save(std::ostream& os) const -> void {
+    Header header = make_header(count);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (count > 0) {
+        os.write(reinterpret_cast<const char*>(keys),
+                 static_cast<std::streamsize>((count + unused_slots) *
+                                              sizeof(Key)));
+    }
+
+    if (!os) {
+        throw std::runtime_error("failed to write FrozenSet");
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::load(std::istream& is) -> FrozenSet {
+    Header header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("not a saved FrozenSet");
+    }
+    check_header(header);
+
+    if (!fits(header.count, std::numeric_limits<std::streamsize>::max())) {
+        throw std::runtime_error("truncated FrozenSet");
+    }
+
+    // A stream doesn't tell how much it holds, so the keys are read a
+    // chunk at a time, and a count past its end fails there instead of
+    // allocating it all up front
+    FrozenSet set;
+    size_t slots = header.count == 0 ? 0 : header.count + unused_slots;
+    constexpr size_t chunk = std::max<size_t>(1, 65536 / sizeof(Key));
+    while (set.owned.size() < slots) {
+        size_t done = set.owned.size();
+        size_t more = std::min(chunk, slots - done);
+        set.owned.resize(done + more);
+        if (!is.read(reinterpret_cast<char*>(set.owned.data() + done),
+                     static_cast<std::streamsize>(more * sizeof(Key)))) {
+            throw std::runtime_error("truncated FrozenSet");
+        }
+    }
+    set.keys = set.owned.data();
+    set.count = header.count;
+    return set;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::first_slot() const -> size_t {
+    if constexpr (Layout == FrozenLayout::sorted) {
+        return 0;
+    } else {
+        if (count == 0) {
+            return 0;
+        }
+        // The leftmost slot of a tree numbered from 1
+        return std::bit_floor(count);
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::next_slot(size_t slot) const
+    -> size_t {
+    if constexpr (Layout == FrozenLayout::sorted) {
+        return slot + 1;
+    } else {
+        if (2 * slot + 1 <= count) {
+            slot = 2 * slot + 1;
+            while (2 * slot <= count) {
+                slot *= 2;
+            }
+            return slot;
+        }
+        // Reaches 0, the end, after the rightmost key
+        return slot >> (std::countr_one(slot) + 1);
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::end_slot() const -> size_t {
+    return Layout == FrozenLayout::sorted ? count : 0;
+}
+
+// Goes down from the root, right whenever `goes_right` says the bound is
+// further right, and left otherwise, until it falls off the tree.
+// The last time it turned left was at the bound, and the turns since
+// then are the trailing ones of the final position.
+template <typename Key, typename Compare, FrozenLayout Layout>
+template <typename GoesRight>
+auto FrozenSet<Key, Compare, Layout>::eytzinger_search(
+    GoesRight goes_right) const -> size_t {
+    auto address = reinterpret_cast<std::uintptr_t>(keys);
+    size_t slot = 1;
+
+    while (slot <= count) {
+        // Only a hint, a slot past the end is never read
+        __builtin_prefetch(reinterpret_cast<const void*>(
+            address + slot * prefetch_stride * sizeof(Key)));
+        slot = 2 * slot + static_cast<size_t>(goes_right(keys[slot]));
+    }
+
+    return slot >> (std::countr_one(slot) + 1);
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::begin() const -> iterator {
+    return iterator(this, first_slot());
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::end() const -> iterator {
+    return iterator(this, end_slot());
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::size() const -> size_t {
+    return count;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::empty() const -> bool {
+    return count == 0;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::key_comp() const -> Compare {
+    return comp;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::contains(const Key& value) const
+    -> bool {
+    return find(value) != end();
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::find(const Key& value) const
+    -> iterator {
+    iterator it = lower_bound(value);
+    return it == end() || comp(value, *it) ? end() : it;
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::upper_bound(const Key& value) const
+    -> iterator {
+    if constexpr (Layout == FrozenLayout::sorted) {
+        return iterator(
+            this, std::upper_bound(keys, keys + count, value, comp) - keys);
+    } else {
+        return iterator(this, eytzinger_search([&](const Key& key) {
+                            return !comp(value, key);
+                        }));
+    }
+}
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::lower_bound(const Key& value) const
+    -> iterator {
+    if constexpr (Layout == FrozenLayout::sorted) {
+        return iterator(
+            this, std::lower_bound(keys, keys + count, value, comp) - keys);
+    } else {
+        return iterator(this, eytzinger_search([&](const Key& key) {
+                            return comp(key, value);
+                        }));
+    }
+}
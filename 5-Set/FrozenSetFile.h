@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FrozenSet.h"
+
+// FrozenSet::open, kept apart because mapping a file needs POSIX, and
+// FrozenSet.h is included by every Set for freeze()
+
+template <typename Key, typename Compare, FrozenLayout Layout>
+auto FrozenSet<Key, Compare, Layout>::open(const std::string& path)
+    -> FrozenSet {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::system_error(errno, std::generic_category(),
+                                "can't open " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "can't stat " + path);
+    }
+    auto file_size = static_cast<size_t>(info.st_size);
+    if (file_size < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("not a saved FrozenSet: " + path);
+    }
+
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(),
+                                "can't map " + path);
+    }
+
+    FrozenSet set;
+    set.mapping = mapping;
+    set.mapping_size = file_size;
+    set.unmap = [](void* mapping, size_t size) { munmap(mapping, size); };
+
+    const auto* header = static_cast<const Header*>(mapping);
+    check_header(*header);
+    if (!fits(header->count, file_size - sizeof(Header))) {
+        throw std::runtime_error("truncated FrozenSet file: " + path);
+    }
+    size_t slots = header->count == 0 ? 0 : header->count + unused_slots;
+    if (file_size != sizeof(Header) + slots * sizeof(Key)) {
+        throw std::runtime_error("truncated FrozenSet file: " + path);
+    }
+    set.keys = reinterpret_cast<const Key*>(header + 1);
+    set.count = header->count;
+    return set;
+}
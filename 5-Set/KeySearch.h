@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <functional>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Rank queries over a short sorted run of keys, used to search inside
+// a B-tree node. For ints in their natural order they're vectorized:
+// a whole block of keys is compared at once and the mask is popcounted,
+// instead of branching on every key.
+//
+// AVX2 is used whenever the CPU running the program has it, even if the
+// build doesn't target it; otherwise SSE2 on x86, or plain loops elsewhere.
+namespace key_search {
+
+// One version per instruction set, all with the same results.
+// The vector ones leave the keys that don't fill a block to the scalar one.
+namespace detail {
+
+inline auto count_less_scalar(const int* keys, int n, int value) -> int {
+    int i = 0;
+    while (i < n && keys[i] < value) {
+        ++i;
+    }
+    return i;
+}
+
+inline auto count_less_equal_scalar(const int* keys, int n, int value)
+    -> int {
+    int i = 0;
+    while (i < n && keys[i] <= value) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(__SSE2__)
+inline auto count_less_sse2(const int* keys, int n, int value) -> int {
+    int i = 0;
+    __m128i needle = _mm_set1_epi32(value);
+    for (; i + 4 <= n; i += 4) {
+        __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        auto mask = static_cast<unsigned>(
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, needle))));
+        if (mask != 0xf) {
+            return i + std::popcount(mask);
+        }
+    }
+    return i + count_less_scalar(keys + i, n - i, value);
+}
+
+inline auto count_less_equal_sse2(const int* keys, int n, int value) -> int {
+    int i = 0;
+    __m128i needle = _mm_set1_epi32(value);
+    for (; i + 4 <= n; i += 4) {
+        __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        auto mask = static_cast<unsigned>(
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(block, needle))));
+        if (mask != 0) {
+            return i + std::countr_zero(mask);
+        }
+    }
+    return i + count_less_equal_scalar(keys + i, n - i, value);
+}
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) inline auto count_less_avx2(const int* keys,
+                                                            int n,
+                                                            int value) -> int {
+    int i = 0;
+    __m256i needle = _mm256_set1_epi32(value);
+    for (; i + 8 <= n; i += 8) {
+        __m256i block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        auto mask = static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, block))));
+        if (mask != 0xff) {
+            return i + std::popcount(mask);
+        }
+    }
+    return i + count_less_scalar(keys + i, n - i, value);
+}
+
+__attribute__((target("avx2"))) inline auto count_less_equal_avx2(
+    const int* keys,
+    int n,
+    int value) -> int {
+    int i = 0;
+    __m256i needle = _mm256_set1_epi32(value);
+    for (; i + 8 <= n; i += 8) {
+        __m256i block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        auto mask = static_cast<unsigned>(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(block, needle))));
+        if (mask != 0) {
+            return i + std::countr_zero(mask);
+        }
+    }
+    return i + count_less_equal_scalar(keys + i, n - i, value);
+}
+
+// Asked once, before main(); the branch on it always goes the same way
+inline const bool has_avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}();
+#endif
+
+}  // namespace detail
+
+// Number of keys in keys[0, n) that are less than `value`
+inline auto count_less(const int* keys, int n, int value) -> int {
+#if defined(__AVX2__)
+    return detail::count_less_avx2(keys, n, value);
+#else
+#if defined(__x86_64__) || defined(__i386__)
+    if (detail::has_avx2) {
+        return detail::count_less_avx2(keys, n, value);
+    }
+#endif
+#if defined(__SSE2__)
+    return detail::count_less_sse2(keys, n, value);
+#else
+    return detail::count_less_scalar(keys, n, value);
+#endif
+#endif
+}
+
+// Number of keys in keys[0, n) that are less than or equal to `value`
+inline auto count_less_equal(const int* keys, int n, int value) -> int {
+#if defined(__AVX2__)
+    return detail::count_less_equal_avx2(keys, n, value);
+#else
+#if defined(__x86_64__) || defined(__i386__)
+    if (detail::has_avx2) {
+        return detail::count_less_equal_avx2(keys, n, value);
+    }
+#endif
+#if defined(__SSE2__)
+    return detail::count_less_equal_sse2(keys, n, value);
+#else
+    return detail::count_less_equal_scalar(keys, n, value);
+#endif
+#endif
+}
+
+// Whether a search for a `K` among `Key`s ordered by `Compare`
+// can use the int versions above
+template <typename Key, typename K, typename Compare>
+inline constexpr bool vectorized =
+    std::same_as<Key, int> && std::same_as<K, int> &&
+    (std::same_as<Compare, std::less<int>> ||
+     std::same_as<Compare, std::less<>>);
+
+// Number of keys in keys[0, n) that are ordered before `value`
+template <typename Key, typename K, typename Compare>
+auto count_less(const Key* keys, int n, const K& value, const Compare& comp)
+    -> int {
+    if constexpr (vectorized<Key, K, Compare>) {
+        return count_less(keys, n, value);
+    } else {
+        return std::partition_point(
+                   keys, keys + n,
+                   [&](const Key& key) { return comp(key, value); }) -
+               keys;
+    }
+}
+
+// Number of keys in keys[0, n) that aren't ordered after `value`
+template <typename Key, typename K, typename Compare>
+auto count_less_equal(const Key* keys,
+                      int n,
+                      const K& value,
+                      const Compare& comp) -> int {
+    if constexpr (vectorized<Key, K, Compare>) {
+        return count_less_equal(keys, n, value);
+    } else {
+        return std::partition_point(
+                   keys, keys + n,
+                   [&](const Key& key) { return !comp(value, key); }) -
+               keys;
+    }
+}
+
+}  // namespace key_search
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// AVL tree whose copies share their nodes, so copying one is O(1).
+// Every node counts the parents and sets pointing at it. A node with
+// a count of one, reached through nodes that also have a count of one,
+// belongs to this set alone and is changed in place like in any tree.
+// Anything else is copied before it's changed: an insertion or erasure
+// copies the shared part of its path plus whatever a rotation touches,
+// and the other sets keep seeing the nodes they had.
+//
+// Copies can be used and destroyed on different threads, the counts are
+// atomic. One set still can't be changed and read at the same time.
+// Whichever copy lets go of a node last frees it, so copies need
+// allocators that can free each other's memory.
+// Insertions and erasures invalidate this set's iterators, but never the
+// iterators of its copies.
+template <typename Key = int,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<Key>>
+class PersistentSet {
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
+    PersistentSet();
+    explicit PersistentSet(const Compare& comp, const Alloc& alloc = Alloc());
+    PersistentSet(const PersistentSet& other);
+    PersistentSet(PersistentSet&& other) noexcept;
+    auto operator=(const PersistentSet& other) -> PersistentSet&;
+    auto operator=(PersistentSet&& other) noexcept -> PersistentSet&;
+    ~PersistentSet();
+
+    PersistentSet(std::initializer_list<Key> list);
+
+    auto operator==(const PersistentSet& other) const -> bool;
+
+    class iterator;
+    auto begin() const -> iterator;
+    auto end() const -> iterator;
+
+    auto size() const -> size_t;
+    auto empty() const -> bool;
+    auto key_comp() const -> Compare;
+    auto get_allocator() const -> Alloc;
+
+    auto insert(const Key& value) -> bool;
+    auto erase(const Key& value) -> size_t;
+
+    auto contains(const Key& value) const -> bool;
+    auto find(const Key& value) const -> iterator;
+    auto upper_bound(const Key& value) const -> iterator;
+    auto lower_bound(const Key& value) const -> iterator;
+
+    // Whether the two sets still share their whole tree
+    auto shares_with(const PersistentSet& other) const -> bool;
+
+  private:
+    struct Node;
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+
+    Node* root;
+    size_t element_count;
+    [[no_unique_address]]
+    Compare comp;
+    [[no_unique_address]]
+    Alloc alloc;
+
+    auto new_node(const Key& value, Node* left, Node* right) -> Node*;
+    auto delete_node(Node* node) -> void;
+    static auto acquire(Node* node) -> Node*;
+    auto release(Node* node) -> void;
+    auto unshare(Node* node) -> Node*;
+
+    static auto level(const Node* node) -> int;
+    static auto update_level(Node* node) -> void;
+    auto right_rotate(Node* node) -> Node*;
+    auto left_rotate(Node* node) -> Node*;
+    auto rebalance(Node* node) -> Node*;
+
+    auto rec_insert(Node* node, const Key& value) -> Node*;
+    auto rec_erase(Node* node, const Key& value) -> Node*;
+    auto rec_erase_min(Node* node, Node*& min) -> Node*;
+};
+
+template <typename Key, typename Compare, typename Alloc>
+struct PersistentSet<Key, Compare, Alloc>::Node {
+    Key value;
+    Node* left;
+    Node* right;
+    std::uint8_t level;
+    std::atomic<std::uint32_t> refs;
+};
+
+// Keeps the nodes whose values are still to come: the current one on
+// top, below it every ancestor that was left by going down to the left.
+// Nothing points back up in a shared tree, so the iterator remembers it.
+template <typename Key, typename Compare, typename Alloc>
+class PersistentSet<Key, Compare, Alloc>::iterator {
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = Key;
+    using pointer = const Key*;
+    using reference = const Key&;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator() = default;
+
+    auto operator*() const -> const Key& { return path.back()->value; }
+    auto operator->() const -> const Key* { return &path.back()->value; }
+
+    auto operator++() -> iterator& {
+        const Node* node = path.back()->right;
+        path.pop_back();
+        descend_left(node);
+        return *this;
+    }
+
+    auto operator++(int) -> iterator {
+        iterator copy = *this;
+        ++*this;
+        return copy;
+    }
+
+    auto operator==(const iterator& other) const -> bool {
+        if (path.empty() || other.path.empty()) {
+            return path.empty() == other.path.empty();
+        }
+        return path.back() == other.path.back();
+    }
+
+  private:
+    friend class PersistentSet;
+
+    std::vector<const Node*> path;
+
+    auto descend_left(const Node* node) -> void {
+        while (node != nullptr) {
+            path.push_back(node);
+            node = node->left;
+        }
+    }
+};
+
+template <typename Key, typename Compare, typename Alloc>
+PersistentSet<Key, Compare, Alloc>::PersistentSet()
+    : PersistentSet(Compare()) {}
+
+template <typename Key, typename Compare, typename Alloc>
+PersistentSet<Key, Compare, Alloc>::PersistentSet(const Compare& comp,
+                                                  const Alloc& alloc)
+    : root(nullptr), element_count(0), comp(comp), alloc(alloc) {}
+
+// The whole point: the copy just points at the same root
+template <typename Key, typename Compare, typename Alloc>
+PersistentSet<Key, Compare, Alloc>::PersistentSet(const PersistentSet& other)
+    : root(acquire(other.root)),
+      element_count(other.element_count),
+      comp(other.comp),
+      alloc(other.alloc) {}
+
+template <typename Key, typename Compare, typename Alloc>
+PersistentSet<Key, Compare, Alloc>::PersistentSet(
+    PersistentSet&& other) noexcept
+    : root(std::exchange(other.root, nullptr)),
+      element_count(std::exchange(other.element_count, 0)),
+      comp(other.comp),
+      alloc(other.alloc) {}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::operator=(const PersistentSet& other)
+    -> PersistentSet& {
+    Node* old_root = root;
+    root = acquire(other.root);
+    release(old_root);
+    element_count = other.element_count;
+    comp = other.comp;
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::operator=(
+    PersistentSet&& other) noexcept -> PersistentSet& {
+    if (this != &other) {
+        release(root);
+        root = std::exchange(other.root, nullptr);
+        element_count = std::exchange(other.element_count, 0);
+        comp = other.comp;
+    }
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+PersistentSet<Key, Compare, Alloc>::~PersistentSet() {
+    release(root);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+PersistentSet<Key, Compare, Alloc>::PersistentSet(
+    std::initializer_list<Key> list)
+    : PersistentSet() {
+    for (const Key& value : list) {
+        insert(value);
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::new_node(const Key& value,
+                                                  Node* left,
+                                                  Node* right) -> Node* {
+    NodeAlloc node_alloc(alloc);
+    Node* node = std::allocator_traits<NodeAlloc>::allocate(node_alloc, 1);
+    std::allocator_traits<NodeAlloc>::construct(
+        node_alloc, node, value, left, right,
+        static_cast<std::uint8_t>(1 + std::max(level(left), level(right))),
+        1u);
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::delete_node(Node* node) -> void {
+    NodeAlloc node_alloc(alloc);
+    std::allocator_traits<NodeAlloc>::destroy(node_alloc, node);
+    std::allocator_traits<NodeAlloc>::deallocate(node_alloc, node, 1);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::acquire(Node* node) -> Node* {
+    if (node != nullptr) {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+// Drops one reference, and with the last one the node and its own
+// references to its children
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::release(Node* node) -> void {
+    while (node != nullptr &&
+           node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        release(node->left);
+        Node* right = node->right;
+        delete_node(node);
+        node = right;
+    }
+}
+
+// Takes a reference to `node` and returns one to a node that nobody else
+// can see, with the same value and children: `node` itself if this was
+// its only reference, otherwise a copy
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::unshare(Node* node) -> Node* {
+    if (node->refs.load(std::memory_order_acquire) == 1) {
+        return node;
+    }
+    Node* copy =
+        new_node(node->value, acquire(node->left), acquire(node->right));
+    release(node);
+    return copy;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::level(const Node* node) -> int {
+    return node == nullptr ? 0 : node->level;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::update_level(Node* node) -> void {
+    node->level = static_cast<std::uint8_t>(
+        1 + std::max(level(node->left), level(node->right)));
+}
+
+// The rotations get `node` unshared and unshare the child they move up
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::right_rotate(Node* node) -> Node* {
+    Node* left = unshare(node->left);
+    node->left = left->right;
+    left->right = node;
+    update_level(node);
+    update_level(left);
+    return left;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::left_rotate(Node* node) -> Node* {
+    Node* right = unshare(node->right);
+    node->right = right->left;
+    right->left = node;
+    update_level(node);
+    update_level(right);
+    return right;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::rebalance(Node* node) -> Node* {
+    update_level(node);
+    int balance = level(node->left) - level(node->right);
+
+    if (balance > 1) {
+        if (level(node->left->left) < level(node->left->right)) {
+            node->left = left_rotate(unshare(node->left));
+        }
+        return right_rotate(node);
+    }
+
+    if (balance < -1) {
+        if (level(node->right->right) < level(node->right->left)) {
+            node->right = right_rotate(unshare(node->right));
+        }
+        return left_rotate(node);
+    }
+
+    return node;
+}
+
+// Only called once `value` is known to be missing,
+// so every node it unshares on the way down does change
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::rec_insert(Node* node,
+                                                    const Key& value)
+    -> Node* {
+    if (node == nullptr) {
+        return new_node(value, nullptr, nullptr);
+    }
+
+    node = unshare(node);
+    if (comp(value, node->value)) {
+        node->left = rec_insert(node->left, value);
+    } else {
+        node->right = rec_insert(node->right, value);
+    }
+    return rebalance(node);
+}
+
+// Detaches the smallest node of the subtree into `min`
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::rec_erase_min(Node* node,
+                                                       Node*& min) -> Node* {
+    node = unshare(node);
+    if (node->left == nullptr) {
+        min = node;
+        return std::exchange(node->right, nullptr);
+    }
+    node->left = rec_erase_min(node->left, min);
+    return rebalance(node);
+}
+
+// Only called once `value` is known to be there
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::rec_erase(Node* node,
+                                                   const Key& value)
+    -> Node* {
+    node = unshare(node);
+
+    if (comp(value, node->value)) {
+        node->left = rec_erase(node->left, value);
+        return rebalance(node);
+    }
+    if (comp(node->value, value)) {
+        node->right = rec_erase(node->right, value);
+        return rebalance(node);
+    }
+
+    Node* left = node->left;
+    Node* right = node->right;
+    delete_node(node);
+    if (left == nullptr) {
+        return right;
+    }
+    if (right == nullptr) {
+        return left;
+    }
+
+    // The successor takes the erased node's place
+    Node* successor;
+    right = rec_erase_min(right, successor);
+    successor->left = left;
+    successor->right = right;
+    return rebalance(successor);
+}
+
+// Looked up first, so that inserting a present value copies nothing
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::insert(const Key& value) -> bool {
+    if (contains(value)) {
+        return false;
+    }
+    root = rec_insert(root, value);
+    ++element_count;
+    return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::erase(const Key& value) -> size_t {
+    if (!contains(value)) {
+        return 0;
+    }
+    root = rec_erase(root, value);
+    --element_count;
+    return 1;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::operator==(
+    const PersistentSet& other) const -> bool {
+    return size() == other.size() &&
+           (root == other.root || std::ranges::equal(*this, other));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::begin() const -> iterator {
+    iterator it;
+    it.descend_left(root);
+    return it;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::end() const -> iterator {
+    return iterator();
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::size() const -> size_t {
+    return element_count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::empty() const -> bool {
+    return element_count == 0;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::key_comp() const -> Compare {
+    return comp;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::get_allocator() const -> Alloc {
+    return alloc;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::shares_with(
+    const PersistentSet& other) const -> bool {
+    return root == other.root;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::contains(const Key& value) const
+    -> bool {
+    const Node* node = root;
+
+    while (node != nullptr) {
+        bool less = comp(value, node->value);
+        bool greater = comp(node->value, value);
+
+        if (!(less | greater)) {
+            return true;
+        }
+        node = less ? node->left : node->right;
+    }
+
+    return false;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::find(const Key& value) const
+    -> iterator {
+    iterator it = lower_bound(value);
+    if (it == end() || comp(value, *it)) {
+        return end();
+    }
+    return it;
+}
+
+// Every node the search leaves to the left is still to come after the
+// bound, so it goes on the iterator's path
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::lower_bound(const Key& value) const
+    -> iterator {
+    iterator it;
+    const Node* node = root;
+
+    while (node != nullptr) {
+        if (!comp(node->value, value)) {
+            it.path.push_back(node);
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    return it;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto PersistentSet<Key, Compare, Alloc>::upper_bound(const Key& value) const
+    -> iterator {
+    iterator it;
+    const Node* node = root;
+
+    while (node != nullptr) {
+        if (comp(value, node->value)) {
+            it.path.push_back(node);
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+
+    return it;
+}
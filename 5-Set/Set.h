@@ -1,16 +1,102 @@
 #pragma once
 
+// Defining SET_ENGINE_BTREE swaps the AVL tree below for the B+-tree
+// from BTreeSet.h, which has the same interface.
+//
+// Defining SET_ORDER_STATISTICS makes every node of the AVL tree also keep
+// the size of its subtree, which adds nth(), rank() and O(log n) iterator
+// subtraction, at the cost of 4 more bytes per node and an insertion or
+// erasure always walking all the way up to the root.
+//
+// Defining SET_THREADED also threads the AVL tree's nodes into an in-order
+// list, so stepping an iterator is O(1) in the worst case instead of
+// amortized. That costs 8 more bytes per node, and on sets too large for
+// the cache the bigger nodes make a full iteration slower, not faster:
+// about 164 ns per key instead of 103 at 1M keys.
+#if defined(SET_ENGINE_BTREE) && defined(SET_ORDER_STATISTICS)
+#error "the B-tree engine doesn't keep subtree sizes"
+#endif
+
+#if defined(SET_ENGINE_BTREE)
+
+#include <functional>
+#include <memory>
+
+#include "BTreeSet.h"
+
+template <typename Key = int,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<Key>>
+using Set = BTreeSet<Key, Compare, Alloc>;
+
+#else
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <ostream>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "../Common/ContainerStats.h"
+#include "FrozenSet.h"
+#include "SetAlgebra.h"
+
+// AVL tree whose nodes live in one contiguous pool and refer to each other
+// by 32-bit indices instead of pointers.
+// Iterators stay valid across insertions, but references to elements don't:
+// the pool may move when it grows. split() and join() hand pools from one
+// set to another, and say which iterators they leave valid.
+//
+// Keys are ints unless told otherwise. Key has to be default constructible,
+// the sentinel node holds one. If Compare declares `is_transparent`, like
+// std::less<> does, lookups take anything it can compare with a Key.
+template <typename Key = int,
+          typename Compare = std::less<Key>,
+          typename Alloc = std::allocator<Key>>
 class Set {
   public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+
     Set();
+    explicit Set(const Compare& comp, const Alloc& alloc = Alloc());
     Set(const Set& other);
     auto operator=(const Set& other) -> Set&;
+    // Moving takes the pool over, sentinel and all, so a moved-from set
+    // can only be assigned to or destroyed. Iterators into it are
+    // invalidated, they name the set and not the pool.
+    Set(Set&& other) noexcept;
+    auto operator=(Set&& other) noexcept(moves_pool) -> Set&;
     ~Set();
 
-    Set(std::initializer_list<int> list);
+    Set(std::initializer_list<Key> list);
+
+    // Builds a perfectly balanced tree in O(n) if the range is sorted,
+    // otherwise sorts it first. Duplicates are dropped.
+    template <std::input_iterator It, std::sentinel_for<It> Sn>
+        requires std::convertible_to<std::iter_value_t<It>, Key>
+    Set(It begin, Sn end);
+    template <std::input_iterator It, std::sentinel_for<It> Sn>
+        requires std::convertible_to<std::iter_value_t<It>, Key>
+    auto assign(It begin, Sn end) -> void;
 
     auto operator==(const Set& other) const -> bool;
 
@@ -20,53 +106,1599 @@ class Set {
 
     auto size() const -> size_t;
     auto empty() const -> bool;
+    auto key_comp() const -> Compare;
+    auto get_allocator() const -> Alloc;
 
-    auto insert(int value) -> std::pair<iterator, bool>;
-    auto erase(int value) -> size_t;
+    auto insert(const Key& value) -> std::pair<iterator, bool>;
+    auto insert(Key&& value) -> std::pair<iterator, bool>;
+    // In amortized O(1) if `value` goes right before `hint` or right after
+    // it, like insert(value) otherwise. Returns where `value` is either way.
+    auto insert(iterator hint, const Key& value) -> iterator;
+    auto insert(iterator hint, Key&& value) -> iterator;
+    auto erase(const Key& value) -> size_t;
     auto erase(iterator it) -> iterator;
-    auto contains(int value) -> bool;
-    auto find(int value) const -> iterator;
-    auto upper_bound(int value) const -> iterator;
-    auto lower_bound(int value) const -> iterator;
+    // Cuts the tree around [first, last) and joins what's left,
+    // in O(log n + k) for k erased values
+    auto erase(iterator first, iterator last) -> iterator;
+    // Erases the values in [lo, hi) and returns how many there were
+    auto erase_range(const Key& lo, const Key& hi) -> size_t;
+
+    // Moves the values not less than `key` into the set returned.
+    // Every set keeps its nodes in a pool of its own, so only one side can
+    // stay where it is: the smaller side is moved value by value,
+    // in O(log n + the smaller side). If the values that stay in this set
+    // aren't the smaller side, iterators to them stay valid; all other
+    // iterators into this set are invalidated.
+    auto split(const Key& key) -> Set;
+    // Moves every value of `other` into this set, leaving `other` empty.
+    // The smaller of the two is moved into the larger one, in amortized
+    // O(1) per value if all of them go before or after the other set's.
+    // Iterators into this set stay valid unless `other` was larger;
+    // iterators into `other` are invalidated.
+    auto join(Set&& other) -> void;
+
+    auto contains(const Key& value) const -> bool;
+    auto find(const Key& value) const -> iterator;
+    auto upper_bound(const Key& value) const -> iterator;
+    auto lower_bound(const Key& value) const -> iterator;
+
+    // Heterogeneous versions of the lookups above
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto contains(const K& value) const -> bool;
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto find(const K& value) const -> iterator;
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto upper_bound(const K& value) const -> iterator;
+    template <typename K>
+        requires requires { typename Compare::is_transparent; }
+    auto lower_bound(const K& value) const -> iterator;
+
+#if defined(SET_ORDER_STATISTICS)
+    // The k-th smallest value, counting from 0, or end() if there are fewer
+    auto nth(size_t k) const -> iterator;
+    // Number of values less than `value`
+    auto rank(const Key& value) const -> size_t;
+#endif
+
+    // Look up every key of `keys` and write each answer to the same position
+    // of `out`, which must be at least as long.
+    // Several lookups walk down side by side and prefetch their next node,
+    // so their cache misses overlap instead of waiting on each other.
+    auto contains_many(std::span<const Key> keys, std::span<bool> out) const
+        -> void;
+    auto find_many(std::span<const Key> keys, std::span<iterator> out) const
+        -> void;
+
+    // Copies the values in [from, to] into `out`, as many as fit,
+    // and returns how many were copied.
+    // If `out` fills up, scan again starting after the last one copied.
+    auto scan(const Key& from, const Key& to, std::span<Key> out) const
+        -> size_t;
+
+    // A read-only copy laid out for the fastest lookups,
+    // for when the set is done changing
+    auto freeze() const -> FrozenSet<Key, Compare, FrozenLayout::eytzinger>
+        requires std::is_trivially_copyable_v<Key>;
+
+    // New sets made of the keys in either set, in both, or only in `a`.
+    // Large inputs are cut into key ranges that are merged in parallel.
+    friend auto set_union(const Set& a, const Set& b) -> Set {
+        return combine(a, b, set_algebra::Operation::set_union);
+    }
+    friend auto set_intersection(const Set& a, const Set& b) -> Set {
+        return combine(a, b, set_algebra::Operation::intersection);
+    }
+    friend auto set_difference(const Set& a, const Set& b) -> Set {
+        return combine(a, b, set_algebra::Operation::difference);
+    }
 
     auto dump_graphviz(std::ostream& os) -> void;
 
   private:
     struct Node;
-    Node* root;
+    using index_t = std::uint32_t;
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    // Whether move assignment can always take the other set's pool
+    static constexpr bool moves_pool =
+        NodeTraits::propagate_on_container_move_assignment::value ||
+        NodeTraits::is_always_equal::value;
+
+    // pool[nil] is a sentinel with level 0, so children never need null checks
+    static constexpr index_t nil = 0;
+
+    std::vector<Node, NodeAlloc> pool;
+    index_t root;
+    index_t free_list;  // erased slots, chained through `left`
+    // The smallest and largest nodes, for begin() and for hints at either end
+    index_t leftmost;
+    index_t rightmost;
     size_t element_count;
+    [[no_unique_address]]
+    Compare comp;
+
+    auto compute_level(index_t node) const -> std::uint8_t;
+    auto balance(index_t node) const -> int;
+    auto min_in_subtree(index_t node) const -> index_t;
+    auto max_in_subtree(index_t node) const -> index_t;
+    // In-order neighbours, nil past either end. prev_node(nil) is the
+    // largest node, so end() steps back like any other iterator.
+    auto next_node(index_t node) const -> index_t;
+    auto prev_node(index_t node) const -> index_t;
+    auto reset_ends() -> void;
+
+#if defined(SET_ORDER_STATISTICS)
+    auto compute_size(index_t node) const -> index_t;
+    auto recount_to_root(index_t node) -> void;
+    auto position(index_t node) const -> size_t;
+#endif
 
-    static auto rec_copy(Node* from, Node* to_parent, Node*& to) -> void;
-    static auto rec_destroy(Node* node) -> void;
-    static auto rec_insert(Node* parent, Node*& node, int value)
-        -> std::pair<Node*, bool>;
-    static auto rec_yank(Node*& node, int value) -> Node*;
+    template <typename K>
+    auto find_node(const K& value) const -> index_t;
+    template <typename K>
+    auto upper_bound_node(const K& value) const -> index_t;
+    template <typename K>
+    auto lower_bound_node(const K& value) const -> index_t;
+    template <typename F>
+    auto lookup_many(std::span<const Key> keys, F&& found) const -> void;
+
+    template <typename V>
+    auto insert_value(V&& value) -> std::pair<iterator, bool>;
+    template <typename V>
+    auto insert_hinted(iterator hint, V&& value) -> iterator;
+    template <typename V>
+    auto attach(index_t parent, bool as_left, V&& value) -> index_t;
+    template <typename V>
+    auto new_node(index_t parent, V&& value) -> index_t;
+    auto free_node(index_t node) -> void;
+    // Free every node of a subtree cut off the tree, and return how many
+    auto free_subtree(index_t tree) -> size_t;
+    auto take_subtree(index_t tree, std::vector<Key>& out) -> void;
+    auto erase_node(index_t node) -> void;
+
+    // Cutting and joining subtrees only relinks nodes, and leaves the
+    // threads and the ends alone. Every subtree passed in or returned has
+    // nil for its root's parent.
+    auto link(index_t node, index_t left, index_t right) -> void;
+    auto join_trees(index_t left, index_t middle, index_t right) -> index_t;
+    auto join_trees(index_t left, index_t right) -> index_t;
+    auto extract_min(index_t tree) -> std::pair<index_t, index_t>;
+    auto split_tree(index_t tree, const Key& key)
+        -> std::pair<index_t, index_t>;
+    auto swap_contents(Set& other) -> void;
+
+    auto assign_values(std::vector<Key> values) -> void;
+    auto rec_build(index_t parent, index_t from, index_t to) -> index_t;
+
+    auto split_keys(size_t count) const -> std::vector<Key>;
+    auto rec_split_keys(index_t node, int depth, std::vector<Key>& out) const
+        -> void;
+    static auto combine(const Set& a,
+                        const Set& b,
+                        set_algebra::Operation op) -> Set;
+    static auto merged(const Set& a,
+                       const Set& b,
+                       set_algebra::Operation op) -> Set;
+    static auto edited(const Set& a,
+                       const Set& b,
+                       set_algebra::Operation op) -> Set;
+
+    auto replace_child(index_t parent, index_t old_child, index_t new_child)
+        -> void;
+    auto right_rotate(index_t x) -> index_t;
+    auto left_rotate(index_t x) -> index_t;
+    auto rebalance(index_t node) -> index_t;
+
+    auto rec_dump_graphviz(index_t node, std::ostream& os) -> void;
+};
 
-    static auto right_rotate(Node*& x) -> void;
-    static auto left_rotate(Node*& x) -> void;
+// With SET_THREADED, every node is also threaded into a circular in-order
+// list through `prev` and `next`, with the sentinel as its head.
+template <typename Key, typename Compare, typename Alloc>
+struct Set<Key, Compare, Alloc>::Node {
+    index_t parent = nil;
+    index_t left = nil;
+    index_t right = nil;
+#if defined(SET_THREADED)
+    index_t prev = nil;
+    index_t next = nil;
+#endif
+    Key value;
+#if defined(SET_ORDER_STATISTICS)
+    index_t size;  // nodes in the subtree rooted here
+#endif
+    // An AVL tree of 2^32 nodes is less than 48 levels high
+    std::uint8_t level;
 
-    static auto rec_dump_graphviz(Node* node, std::ostream& os) -> void;
+#if defined(SET_ORDER_STATISTICS)
+    // The sentinel, at level 0, is an empty subtree
+    Node(Key value, std::uint8_t level)
+        : value(std::move(value)), size(level == 0 ? 0 : 1), level(level) {}
+#else
+    Node(Key value, std::uint8_t level)
+        : value(std::move(value)), level(level) {}
+#endif
 };
 
-class Set::iterator {
+template <typename Key, typename Compare, typename Alloc>
+class Set<Key, Compare, Alloc>::iterator {
   public:
     using difference_type = std::ptrdiff_t;
-    using value_type = const int;
+    using value_type = const Key;
 
     iterator();
     auto operator==(const iterator& other) const -> bool;
     auto operator++() -> iterator&;    // Prefix
     auto operator++(int) -> iterator;  // Postfix
-    auto operator*() const -> const int&;
-    auto operator->() const -> const int*;
+    auto operator*() const -> const Key&;
+    auto operator->() const -> const Key*;
+
+#if defined(SET_ORDER_STATISTICS)
+    // Lets std::ranges::distance count in O(log n) instead of stepping
+    friend auto operator-(const iterator& a, const iterator& b)
+        -> difference_type {
+        return a.position() - b.position();
+    }
+#endif
 
   private:
     friend class Set;
 
-    Node* node;
+    const Set* set;
+    index_t node;
+
+    iterator(const Set* set, index_t node);
 
-    explicit iterator(Node* node);
+#if defined(SET_ORDER_STATISTICS)
+    auto position() const -> difference_type;
+#endif
 };
-static_assert(std::forward_iterator<Set::iterator>);
+static_assert(std::forward_iterator<Set<>::iterator>);
+#if defined(SET_ORDER_STATISTICS)
+static_assert(std::sized_sentinel_for<Set<>::iterator, Set<>::iterator>);
+#endif
+
+template <std::input_iterator It, std::sentinel_for<It> Sn>
+Set(It, Sn) -> Set<std::iter_value_t<It>>;
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::compute_level(index_t node) const
+    -> std::uint8_t {
+    std::uint8_t lh = pool[pool[node].left].level;
+    std::uint8_t rh = pool[pool[node].right].level;
+    return 1 + std::max(lh, rh);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::balance(index_t node) const -> int {
+    int lh = pool[pool[node].left].level;
+    int rh = pool[pool[node].right].level;
+    return lh - rh;
+}
+
+#if defined(SET_ORDER_STATISTICS)
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::compute_size(index_t node) const -> index_t {
+    return 1 + pool[pool[node].left].size + pool[pool[node].right].size;
+}
+
+// Unlike the levels, every size on the way up changes,
+// so this can't stop early like the retracing does
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::recount_to_root(index_t node) -> void {
+    for (; node != nil; node = pool[node].parent) {
+        pool[node].size = compute_size(node);
+    }
+}
+
+// Number of nodes before `node` in order
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::position(index_t node) const -> size_t {
+    if (node == nil) {
+        return element_count;
+    }
+
+    size_t before = pool[pool[node].left].size;
+    for (index_t parent = pool[node].parent; parent != nil;
+         node = parent, parent = pool[node].parent) {
+        if (pool[parent].right == node) {
+            before += pool[pool[parent].left].size + 1;
+        }
+    }
+    return before;
+}
+#endif
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::min_in_subtree(index_t node) const -> index_t {
+    while (pool[node].left != nil) {
+        node = pool[node].left;
+    }
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::max_in_subtree(index_t node) const -> index_t {
+    while (pool[node].right != nil) {
+        node = pool[node].right;
+    }
+    return node;
+}
+
+// Without the threads, a step climbs the tree when there's no subtree to go
+// down into. Over a whole iteration that's amortized O(1) per step, and
+// stepping past either end is O(1) thanks to the ends being kept.
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::next_node(index_t node) const -> index_t {
+#if defined(SET_THREADED)
+    return pool[node].next;
+#else
+    if (node == rightmost) {
+        return nil;
+    }
+    if (pool[node].right != nil) {
+        return min_in_subtree(pool[node].right);
+    }
+    while (pool[pool[node].parent].right == node) {
+        node = pool[node].parent;
+    }
+    return pool[node].parent;
+#endif
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::prev_node(index_t node) const -> index_t {
+#if defined(SET_THREADED)
+    return pool[node].prev;
+#else
+    if (node == nil) {
+        return rightmost;
+    }
+    if (node == leftmost) {
+        return nil;
+    }
+    if (pool[node].left != nil) {
+        return max_in_subtree(pool[node].left);
+    }
+    while (pool[pool[node].parent].left == node) {
+        node = pool[node].parent;
+    }
+    return pool[node].parent;
+#endif
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::reset_ends() -> void {
+    leftmost = root == nil ? nil : min_in_subtree(root);
+    rightmost = root == nil ? nil : max_in_subtree(root);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto Set<Key, Compare, Alloc>::new_node(index_t parent, V&& value)
+    -> index_t {
+    index_t node;
+
+    if (free_list != nil) {
+        node = free_list;
+        free_list = pool[node].left;
+        pool[node] = Node(std::forward<V>(value), 1);
+    } else {
+        if (pool.size() > std::numeric_limits<index_t>::max()) {
+            throw std::length_error(
+                "Set can't hold more than 2^32 - 1 elements");
+        }
+        node = pool.size();
+        pool.emplace_back(std::forward<V>(value), 1);
+    }
+
+    pool[node].parent = parent;
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::free_node(index_t node) -> void {
+    // don't keep whatever the key owns alive until the slot is reused
+    if constexpr (!std::is_trivially_destructible_v<Key>) {
+        pool[node].value = Key();
+    }
+    pool[node].left = free_list;
+    free_list = node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::free_subtree(index_t tree) -> size_t {
+    if (tree == nil) {
+        return 0;
+    }
+    index_t left = pool[tree].left;
+    index_t right = pool[tree].right;
+    free_node(tree);
+    return 1 + free_subtree(left) + free_subtree(right);
+}
+
+// Moves the values of a subtree cut off the tree to `out`, in order,
+// and frees its nodes
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::take_subtree(index_t tree,
+                                            std::vector<Key>& out) -> void {
+    if (tree == nil) {
+        return;
+    }
+    take_subtree(pool[tree].left, out);
+    index_t right = pool[tree].right;
+    out.push_back(std::move(pool[tree].value));
+    free_node(tree);
+    take_subtree(right, out);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::Set() : Set(Compare()) {}
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::Set(const Compare& comp, const Alloc& alloc)
+    : pool(1, Node(Key(), 0), NodeAlloc(alloc)),
+      root(nil),
+      free_list(nil),
+      leftmost(nil),
+      rightmost(nil),
+      element_count(0),
+      comp(comp) {}
+
+// Copying the pool copies the whole tree, links included
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::Set(const Set& other) = default;
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::operator=(const Set& other) -> Set& = default;
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::Set(Set&& other) noexcept
+    : pool(std::move(other.pool)),
+      root(std::exchange(other.root, nil)),
+      free_list(std::exchange(other.free_list, nil)),
+      leftmost(std::exchange(other.leftmost, nil)),
+      rightmost(std::exchange(other.rightmost, nil)),
+      element_count(std::exchange(other.element_count, 0)),
+      comp(other.comp) {}
+
+// With an allocator that can't free the other set's pool, the pool moves
+// node by node, which keeps the indices and so the links
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::operator=(Set&& other) noexcept(moves_pool)
+    -> Set& {
+    if (this != &other) {
+        pool = std::move(other.pool);
+        root = std::exchange(other.root, nil);
+        free_list = std::exchange(other.free_list, nil);
+        leftmost = std::exchange(other.leftmost, nil);
+        rightmost = std::exchange(other.rightmost, nil);
+        element_count = std::exchange(other.element_count, 0);
+        comp = other.comp;
+    }
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::~Set() = default;
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::Set(std::initializer_list<Key> list)
+    : Set(list.begin(), list.end()) {}
+
+template <typename Key, typename Compare, typename Alloc>
+template <std::input_iterator It, std::sentinel_for<It> Sn>
+    requires std::convertible_to<std::iter_value_t<It>, Key>
+Set<Key, Compare, Alloc>::Set(It begin, Sn end) : Set() {
+    assign(begin, end);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <std::input_iterator It, std::sentinel_for<It> Sn>
+    requires std::convertible_to<std::iter_value_t<It>, Key>
+auto Set<Key, Compare, Alloc>::assign(It begin, Sn end) -> void {
+    std::vector<Key> values;
+    if constexpr (std::sized_sentinel_for<Sn, It>) {
+        values.reserve(end - begin);
+    }
+    for (; begin != end; ++begin) {
+        values.push_back(*begin);
+    }
+    assign_values(std::move(values));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::assign_values(std::vector<Key> values)
+    -> void {
+    if (!std::ranges::is_sorted(values, comp)) {
+        std::ranges::sort(values, comp);
+    }
+    auto duplicates = std::ranges::unique(
+        values, [&](const Key& a, const Key& b) { return !comp(a, b); });
+    values.erase(duplicates.begin(), duplicates.end());
+
+    if (values.size() >= std::numeric_limits<index_t>::max()) {
+        throw std::length_error("Set can't hold more than 2^32 - 1 elements");
+    }
+
+    // Slot i + 1 gets the i-th smallest value, so the pool is in order
+    pool.clear();
+    pool.reserve(values.size() + 1);
+    pool.emplace_back(Key(), 0);
+    for (Key& value : values) {
+        pool.emplace_back(std::move(value), 1);
+    }
+
+#if defined(SET_THREADED)
+    index_t last = pool.size() - 1;
+    for (index_t node = 0; node <= last; ++node) {
+        pool[node].prev = node == 0 ? last : node - 1;
+        pool[node].next = node == last ? 0 : node + 1;
+    }
+#endif
+
+    free_list = nil;
+    element_count = values.size();
+    root = rec_build(nil, 1, pool.size());
+    reset_ends();
+}
+
+// Links slots [from, to) into a perfectly balanced subtree
+// and returns its root, the middle slot
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::rec_build(index_t parent,
+                                         index_t from,
+                                         index_t to) -> index_t {
+    if (from == to) {
+        return nil;
+    }
+
+    index_t mid = from + (to - from) / 2;
+
+    pool[mid].parent = parent;
+    pool[mid].left = rec_build(mid, from, mid);
+    pool[mid].right = rec_build(mid, mid + 1, to);
+    pool[mid].level = compute_level(mid);
+#if defined(SET_ORDER_STATISTICS)
+    pool[mid].size = compute_size(mid);
+#endif
+
+    return mid;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::operator==(const Set& other) const -> bool {
+    return std::ranges::equal(*this, other);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::size() const -> size_t {
+    return element_count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::empty() const -> bool {
+    return element_count == 0;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::key_comp() const -> Compare {
+    return comp;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::get_allocator() const -> Alloc {
+    return Alloc(pool.get_allocator());
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::replace_child(index_t parent,
+                                             index_t old_child,
+                                             index_t new_child) -> void {
+    if (parent == nil) {
+        root = new_child;
+    } else if (pool[parent].left == old_child) {
+        pool[parent].left = new_child;
+    } else {
+        pool[parent].right = new_child;
+    }
+}
+
+// |                                         |
+// |    x                             y      |
+// |   /  \     left_rotate(x)       / \     |
+// |  T1   y       ------->         x   T3   |
+// |      / \                      / \       |
+// |     T2  T3                   T1  T2     |
+// |                                         |
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::left_rotate(index_t x) -> index_t {
+    container_stats::count_rotation(pool.get_allocator());
+
+    index_t y = pool[x].right;
+    index_t T2 = pool[y].left;
+
+    replace_child(pool[x].parent, x, y);
+
+    pool[y].left = x;
+    pool[y].parent = pool[x].parent;
+    pool[x].right = T2;
+    pool[x].parent = y;
+
+    if (T2 != nil) {
+        pool[T2].parent = x;
+    }
+
+    pool[x].level = compute_level(x);
+    pool[y].level = compute_level(y);
+#if defined(SET_ORDER_STATISTICS)
+    pool[x].size = compute_size(x);
+    pool[y].size = compute_size(y);
+#endif
+
+    return y;
+}
+
+// |                                         |
+// |      x                         y        |
+// |     / \     right_rotate(x)   /  \      |
+// |    y   T3      ------->      T1   x     |
+// |   / \                            / \    |
+// |  T1  T2                         T2  T3  |
+// |                                         |
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::right_rotate(index_t x) -> index_t {
+    container_stats::count_rotation(pool.get_allocator());
+
+    index_t y = pool[x].left;
+    index_t T2 = pool[y].right;
+
+    replace_child(pool[x].parent, x, y);
+
+    pool[y].right = x;
+    pool[y].parent = pool[x].parent;
+    pool[x].left = T2;
+    pool[x].parent = y;
+
+    if (T2 != nil) {
+        pool[T2].parent = x;
+    }
+
+    pool[x].level = compute_level(x);
+    pool[y].level = compute_level(y);
+#if defined(SET_ORDER_STATISTICS)
+    pool[x].size = compute_size(x);
+    pool[y].size = compute_size(y);
+#endif
+
+    return y;
+}
+
+// Rotates a subtree whose sides differ in height by two back into balance,
+// returns the new root of the subtree
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::rebalance(index_t node) -> index_t {
+    int balance = this->balance(node);
+
+    if (balance > 1) {
+        if (this->balance(pool[node].left) < 0) {
+            // left right case
+            left_rotate(pool[node].left);
+        }
+        // left left case
+        return right_rotate(node);
+    }
+
+    if (balance < -1) {
+        if (this->balance(pool[node].right) > 0) {
+            // right left case
+            right_rotate(pool[node].right);
+        }
+        // right right case
+        return left_rotate(node);
+    }
+
+    return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::insert(const Key& value)
+    -> std::pair<iterator, bool> {
+    return insert_value(value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::insert(Key&& value)
+    -> std::pair<iterator, bool> {
+    return insert_value(std::move(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::insert(iterator hint, const Key& value)
+    -> iterator {
+    return insert_hinted(hint, value);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::insert(iterator hint, Key&& value)
+    -> iterator {
+    return insert_hinted(hint, std::move(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto Set<Key, Compare, Alloc>::insert_value(V&& value)
+    -> std::pair<iterator, bool> {
+    index_t parent = nil;
+    index_t current = root;
+    bool went_left = false;
+
+    while (current != nil) {
+        went_left = comp(value, pool[current].value);
+        bool went_right = comp(pool[current].value, value);
+
+        if (!(went_left | went_right)) {
+            return {iterator(this, current), false};
+        }
+        parent = current;
+        current = went_left ? pool[current].left : pool[current].right;
+    }
+
+    index_t node = attach(parent, went_left, std::forward<V>(value));
+    return {iterator(this, node), true};
+}
+
+// Both neighbours of the spot are found without a comparison, in O(1) with
+// the threads, and otherwise in amortized O(1) when inserting in order next
+// to the last insertion or at either end. If `value` fits between them,
+// one of them has a free child slot right there: `next` if it has no left
+// subtree, otherwise `prev`, the largest key in that subtree.
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto Set<Key, Compare, Alloc>::insert_hinted(iterator hint, V&& value)
+    -> iterator {
+    index_t next = hint.node;
+    // A hint to the key before `value`, like the last one inserted,
+    // is as good as one to the key after it
+    if (next != nil && comp(pool[next].value, value)) {
+        next = next_node(next);
+    }
+    index_t prev = prev_node(next);
+
+    if ((prev != nil && !comp(pool[prev].value, value)) ||
+        (next != nil && !comp(value, pool[next].value))) {
+        return insert_value(std::forward<V>(value)).first;
+    }
+
+    if (next != nil && pool[next].left == nil) {
+        return iterator(this, attach(next, true, std::forward<V>(value)));
+    }
+    return iterator(this, attach(prev, false, std::forward<V>(value)));
+}
+
+// Hangs a new node with `value` under `parent`, which has no child on that
+// side (or is nil for an empty tree), and rebalances
+template <typename Key, typename Compare, typename Alloc>
+template <typename V>
+auto Set<Key, Compare, Alloc>::attach(index_t parent, bool as_left, V&& value)
+    -> index_t {
+    index_t node = new_node(parent, std::forward<V>(value));
+
+    if (parent == nil) {
+        root = node;
+        leftmost = node;
+        rightmost = node;
+    } else if (as_left) {
+        pool[parent].left = node;
+        if (parent == leftmost) {
+            leftmost = node;
+        }
+    } else {
+        pool[parent].right = node;
+        if (parent == rightmost) {
+            rightmost = node;
+        }
+    }
+
+#if defined(SET_THREADED)
+    // A new left child comes right before its parent in order,
+    // a new right child right after it
+    index_t prev = as_left ? pool[parent].prev : parent;
+    index_t next = as_left ? parent : pool[parent].next;
+    pool[node].prev = prev;
+    pool[node].next = next;
+    pool[prev].next = node;
+    pool[next].prev = node;
+#endif
+
+    element_count++;
+
+#if defined(SET_ORDER_STATISTICS)
+    recount_to_root(parent);
+#endif
+
+    // Walk back up until some subtree's height doesn't change.
+    // One rotation is always enough after an insertion: it brings the
+    // subtree back to the height it had before, so nothing above changes.
+    for (index_t current = parent; current != nil;
+         current = pool[current].parent) {
+        int balance = this->balance(current);
+        if (balance > 1 || balance < -1) {
+            rebalance(current);
+            break;
+        }
+
+        std::uint8_t level = compute_level(current);
+        if (level == pool[current].level) {
+            break;
+        }
+        pool[current].level = level;
+    }
+
+    return node;
+}
+
+// Unlinks `node` and returns it to the free list.
+// A node with two children is replaced by its successor node itself,
+// not by its value, so iterators to the successor stay valid.
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::erase_node(index_t node) -> void {
+    if (node == leftmost) {
+        leftmost = next_node(node);
+    }
+    if (node == rightmost) {
+        rightmost = prev_node(node);
+    }
+
+    Node& erased = pool[node];
+    index_t retrace_from;
+
+    if (erased.left == nil || erased.right == nil) {
+        index_t child = erased.left != nil ? erased.left : erased.right;
+
+        replace_child(erased.parent, node, child);
+        if (child != nil) {
+            pool[child].parent = erased.parent;
+        }
+
+        retrace_from = erased.parent;
+    } else {
+        index_t successor = min_in_subtree(erased.right);
+        Node& moved = pool[successor];
+
+        if (moved.parent == node) {
+            retrace_from = successor;
+        } else {
+            // the successor has no left child, its right one takes its place
+            retrace_from = moved.parent;
+
+            pool[moved.parent].left = moved.right;
+            if (moved.right != nil) {
+                pool[moved.right].parent = moved.parent;
+            }
+
+            moved.right = erased.right;
+            pool[moved.right].parent = successor;
+        }
+
+        moved.left = erased.left;
+        pool[moved.left].parent = successor;
+        moved.parent = erased.parent;
+        moved.level = erased.level;
+        replace_child(erased.parent, node, successor);
+    }
+
+#if defined(SET_THREADED)
+    pool[erased.prev].next = erased.next;
+    pool[erased.next].prev = erased.prev;
+#endif
+
+    free_node(node);
+    element_count--;
+
+#if defined(SET_ORDER_STATISTICS)
+    // every node whose subtree lost a node is on the way up from here
+    recount_to_root(retrace_from);
+#endif
+
+    // Unlike after an insertion, a rotation may leave the subtree lower
+    // than before, so keep going until a subtree keeps its height
+    for (index_t current = retrace_from; current != nil;) {
+        index_t parent = pool[current].parent;
+        std::uint8_t old_level = pool[current].level;
+
+        pool[current].level = compute_level(current);
+        current = rebalance(current);
+
+        if (pool[current].level == old_level) {
+            break;
+        }
+        current = parent;
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::erase(const Key& value) -> size_t {
+    index_t node = find_node(value);
+
+    if (node == nil) {
+        return 0;
+    }
+
+    erase_node(node);
+    return 1;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::erase(iterator it) -> iterator {
+    iterator next = std::next(it);
+    erase_node(it.node);  // doesn't invalidate any other iterators
+    return next;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::erase(iterator first, iterator last)
+    -> iterator {
+    if (first == last) {
+        return last;
+    }
+
+#if defined(SET_THREADED)
+    index_t before = pool[first.node].prev;
+    pool[before].next = last.node;
+    pool[last.node].prev = before;
+#endif
+
+    // [first, last) ends up as a subtree of its own between two cuts,
+    // and only the rest of the tree is joined back
+    auto [less, erased] = split_tree(root, pool[first.node].value);
+    index_t greater = nil;
+    if (last.node != nil) {
+        std::tie(erased, greater) = split_tree(erased, pool[last.node].value);
+    }
+    root = join_trees(less, greater);
+    element_count -= free_subtree(erased);
+    reset_ends();
+
+    return last;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::erase_range(const Key& lo, const Key& hi)
+    -> size_t {
+    if (!comp(lo, hi)) {
+        return 0;
+    }
+
+    size_t count = element_count;
+    erase(lower_bound(lo), lower_bound(hi));
+    return count - element_count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::split(const Key& key) -> Set {
+    Set result(comp, pool.get_allocator());
+    index_t first = lower_bound_node(key);
+    if (first == nil) {
+        return result;
+    }
+
+    // Step through both sides together, whichever runs out first
+    // is the smaller one, and the larger one is never walked in full
+    index_t less_node = leftmost;
+    index_t greater_node = first;
+    while (less_node != first && greater_node != nil) {
+        less_node = next_node(less_node);
+        greater_node = next_node(greater_node);
+    }
+    bool move_greater = greater_node == nil;
+
+#if defined(SET_THREADED)
+    // the threads of the side that stays close up over the moved one
+    index_t before = move_greater ? pool[first].prev : nil;
+    index_t after = move_greater ? nil : first;
+    pool[before].next = after;
+    pool[after].prev = before;
+#endif
+
+    auto [less, greater] = split_tree(root, key);
+    std::vector<Key> moved;
+    take_subtree(move_greater ? greater : less, moved);
+
+    root = move_greater ? less : greater;
+    reset_ends();
+    element_count -= moved.size();
+    result.assign_values(std::move(moved));
+
+    if (!move_greater) {
+        swap_contents(result);
+    }
+    return result;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::join(Set&& other) -> void {
+    if (&other == this) {
+        return;
+    }
+    if (other.size() > size() &&
+        pool.get_allocator() == other.pool.get_allocator()) {
+        swap_contents(other);
+    }
+    if (other.empty()) {
+        return;
+    }
+
+    // Each value goes right before the one after the last inserted,
+    // which is where it belongs unless the two sets interleave
+    index_t first = other.leftmost;
+    index_t hint = lower_bound_node(other.pool[first].value);
+    for (index_t node = first; node != nil; node = other.next_node(node)) {
+        iterator inserted = insert_hinted(iterator(this, hint),
+                                          std::move(other.pool[node].value));
+        hint = next_node(inserted.node);
+    }
+
+    other.assign_values({});
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::link(index_t node, index_t left, index_t right)
+    -> void {
+    pool[node].left = left;
+    pool[node].right = right;
+    if (left != nil) {
+        pool[left].parent = node;
+    }
+    if (right != nil) {
+        pool[right].parent = node;
+    }
+
+    pool[node].level = compute_level(node);
+#if defined(SET_ORDER_STATISTICS)
+    pool[node].size = compute_size(node);
+#endif
+}
+
+// Joins two trees around `middle`, whose value goes between theirs,
+// in O(1 + the difference in their heights).
+// `middle` is hung off the inner side of the taller tree where
+// that meets the height of the shorter one, then the nodes above it are
+// rebalanced like after an insertion.
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::join_trees(index_t left,
+                                          index_t middle,
+                                          index_t right) -> index_t {
+    int lh = pool[left].level;
+    int rh = pool[right].level;
+
+    if (lh - rh <= 1 && rh - lh <= 1) {
+        link(middle, left, right);
+        pool[middle].parent = nil;
+        return middle;
+    }
+
+    bool left_taller = lh > rh;
+    int target = (left_taller ? rh : lh) + 1;
+    index_t parent = nil;
+    index_t spine = left_taller ? left : right;
+    while (pool[spine].level > target) {
+        parent = spine;
+        spine = left_taller ? pool[spine].right : pool[spine].left;
+    }
+
+    if (left_taller) {
+        link(middle, spine, right);
+        pool[parent].right = middle;
+    } else {
+        link(middle, left, spine);
+        pool[parent].left = middle;
+    }
+    pool[middle].parent = parent;
+
+    // the root of the taller tree has no parent, so this stops right there
+    index_t top = nil;
+    for (index_t current = parent; current != nil;) {
+        index_t up = pool[current].parent;
+        pool[current].level = compute_level(current);
+#if defined(SET_ORDER_STATISTICS)
+        pool[current].size = compute_size(current);
+#endif
+        top = rebalance(current);
+        current = up;
+    }
+    return top;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::join_trees(index_t left, index_t right)
+    -> index_t {
+    if (left == nil) {
+        return right;
+    }
+    if (right == nil) {
+        return left;
+    }
+
+    auto [rest, min] = extract_min(right);
+    return join_trees(left, min, rest);
+}
+
+// Returns the tree without its smallest node, and that node
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::extract_min(index_t tree)
+    -> std::pair<index_t, index_t> {
+    index_t left = pool[tree].left;
+    index_t right = pool[tree].right;
+    if (right != nil) {
+        pool[right].parent = nil;
+    }
+
+    if (left == nil) {
+        return {right, tree};
+    }
+
+    pool[left].parent = nil;
+    auto [rest, min] = extract_min(left);
+    return {join_trees(rest, tree, right), min};
+}
+
+// Cuts a tree into the nodes less than `key` and the rest.
+// Every node on the search path is joined back onto one of the two sides,
+// and the joins' costs add up to O(log n) along the way.
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::split_tree(index_t tree, const Key& key)
+    -> std::pair<index_t, index_t> {
+    if (tree == nil) {
+        return {nil, nil};
+    }
+
+    index_t left = pool[tree].left;
+    index_t right = pool[tree].right;
+    if (left != nil) {
+        pool[left].parent = nil;
+    }
+    if (right != nil) {
+        pool[right].parent = nil;
+    }
+
+    if (comp(pool[tree].value, key)) {
+        auto [less, rest] = split_tree(right, key);
+        return {join_trees(left, tree, less), rest};
+    }
+
+    auto [less, rest] = split_tree(left, key);
+    return {less, join_trees(rest, tree, right)};
+}
+
+// Only for sets whose allocators compare equal
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::swap_contents(Set& other) -> void {
+    pool.swap(other.pool);
+    std::swap(root, other.root);
+    std::swap(free_list, other.free_list);
+    std::swap(leftmost, other.leftmost);
+    std::swap(rightmost, other.rightmost);
+    std::swap(element_count, other.element_count);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto Set<Key, Compare, Alloc>::find_node(const K& value) const -> index_t {
+    index_t current = root;
+
+    while (current != nil) {
+        const Node& node = pool[current];
+        bool less = comp(value, node.value);
+        bool greater = comp(node.value, value);
+
+        if (!(less | greater)) {
+            return current;
+        }
+        current = less ? node.left : node.right;
+    }
+
+    return nil;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto Set<Key, Compare, Alloc>::upper_bound_node(const K& value) const
+    -> index_t {
+    index_t current = root;
+    index_t bound = nil;
+
+    while (current != nil) {
+        if (comp(value, pool[current].value)) {
+            bound = current;
+            current = pool[current].left;
+        } else {
+            current = pool[current].right;
+        }
+    }
+
+    return bound;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+auto Set<Key, Compare, Alloc>::lower_bound_node(const K& value) const
+    -> index_t {
+    index_t current = root;
+    index_t bound = nil;
+
+    while (current != nil) {
+        if (!comp(pool[current].value, value)) {
+            bound = current;
+            current = pool[current].left;
+        } else {
+            current = pool[current].right;
+        }
+    }
+
+    return bound;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::contains(const Key& value) const -> bool {
+    return find_node(value) != nil;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::find(const Key& value) const -> iterator {
+    return iterator(this, find_node(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::upper_bound(const Key& value) const
+    -> iterator {
+    return iterator(this, upper_bound_node(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::lower_bound(const Key& value) const
+    -> iterator {
+    return iterator(this, lower_bound_node(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto Set<Key, Compare, Alloc>::contains(const K& value) const -> bool {
+    return find_node(value) != nil;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto Set<Key, Compare, Alloc>::find(const K& value) const -> iterator {
+    return iterator(this, find_node(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto Set<Key, Compare, Alloc>::upper_bound(const K& value) const -> iterator {
+    return iterator(this, upper_bound_node(value));
+}
+
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+    requires requires { typename Compare::is_transparent; }
+auto Set<Key, Compare, Alloc>::lower_bound(const K& value) const -> iterator {
+    return iterator(this, lower_bound_node(value));
+}
+
+#if defined(SET_ORDER_STATISTICS)
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::nth(size_t k) const -> iterator {
+    index_t current = root;
+
+    while (current != nil) {
+        size_t left_size = pool[pool[current].left].size;
+
+        if (k == left_size) {
+            return iterator(this, current);
+        } else if (k < left_size) {
+            current = pool[current].left;
+        } else {
+            k -= left_size + 1;
+            current = pool[current].right;
+        }
+    }
+
+    return end();
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::rank(const Key& value) const -> size_t {
+    index_t current = root;
+    size_t less = 0;
+
+    while (current != nil) {
+        if (!comp(pool[current].value, value)) {
+            current = pool[current].left;
+        } else {
+            less += pool[pool[current].left].size + 1;
+            current = pool[current].right;
+        }
+    }
+
+    return less;
+}
+#endif
+
+// Runs up to `lanes` lookups at once, one step of each per round.
+// A lane that finishes takes the next key right away, so the batch stays
+// full even though paths through an AVL tree differ in length.
+// Calls found(i, node) for the i-th key, with `nil` for a miss.
+template <typename Key, typename Compare, typename Alloc>
+template <typename F>
+auto Set<Key, Compare, Alloc>::lookup_many(std::span<const Key> keys,
+                                           F&& found) const -> void {
+    constexpr size_t lanes = 16;
+    std::array<size_t, lanes> key;
+    std::array<index_t, lanes> node;
+
+    size_t active = std::min(lanes, keys.size());
+    size_t next_key = active;
+    for (size_t lane = 0; lane < active; ++lane) {
+        key[lane] = lane;
+        node[lane] = root;
+    }
+
+    while (active > 0) {
+        for (size_t lane = 0; lane < active;) {
+            const Node& current = pool[node[lane]];
+            const Key& value = keys[key[lane]];
+
+            // Both comparisons up front, so the step down is a conditional
+            // move rather than a branch that mispredicts half the time
+            bool less = comp(value, current.value);
+            bool greater = comp(current.value, value);
+
+            if (node[lane] != nil && (less | greater)) [[likely]] {
+                node[lane] = less ? current.left : current.right;
+                __builtin_prefetch(&pool[node[lane]]);
+                ++lane;
+                continue;
+            }
+
+            found(key[lane], node[lane]);
+
+            if (next_key < keys.size()) {
+                key[lane] = next_key++;
+                node[lane] = root;
+                ++lane;
+            } else {
+                // the last lane takes this one's place
+                --active;
+                key[lane] = key[active];
+                node[lane] = node[active];
+            }
+        }
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::contains_many(std::span<const Key> keys,
+                                             std::span<bool> out) const
+    -> void {
+    assert(out.size() >= keys.size());
+    lookup_many(keys, [&](size_t i, index_t node) { out[i] = node != nil; });
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::find_many(std::span<const Key> keys,
+                                         std::span<iterator> out) const
+    -> void {
+    assert(out.size() >= keys.size());
+    lookup_many(keys,
+                [&](size_t i, index_t node) { out[i] = iterator(this, node); });
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::scan(const Key& from,
+                                    const Key& to,
+                                    std::span<Key> out) const -> size_t {
+    size_t count = 0;
+
+    for (index_t node = lower_bound_node(from);
+         node != nil && count < out.size() && !comp(to, pool[node].value);
+         node = next_node(node)) {
+        out[count++] = pool[node].value;
+    }
+
+    return count;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::freeze() const
+    -> FrozenSet<Key, Compare, FrozenLayout::eytzinger>
+    requires std::is_trivially_copyable_v<Key>
+{
+    return FrozenSet<Key, Compare, FrozenLayout::eytzinger>(*this, comp);
+}
+
+// The top levels of an AVL tree are complete, and the in-order keys of
+// the top d levels cut the set into 2^d parts of similar size
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::split_keys(size_t count) const
+    -> std::vector<Key> {
+    std::vector<Key> keys;
+    rec_split_keys(root, std::bit_width(count), keys);
+    return keys;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::rec_split_keys(index_t node,
+                                              int depth,
+                                              std::vector<Key>& out) const
+    -> void {
+    if (node == nil || depth == 0) {
+        return;
+    }
+
+    rec_split_keys(pool[node].left, depth - 1, out);
+    out.push_back(pool[node].value);
+    rec_split_keys(pool[node].right, depth - 1, out);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::combine(const Set& a,
+                                       const Set& b,
+                                       set_algebra::Operation op) -> Set {
+    return set_algebra::by_edits(a, b, op)
+               ? edited(a, b, op)
+               : merged(a, b, op);
+}
+
+// The copy gets room for the new keys up front, or the pool would be
+// copied once more as soon as it grows
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::edited(const Set& a,
+                                      const Set& b,
+                                      set_algebra::Operation op) -> Set {
+    const Set& small = a.size() < b.size() ? a : b;
+    const Set& large = a.size() < b.size() ? b : a;
+
+    Set result(large.comp, large.pool.get_allocator());
+    size_t added = op == set_algebra::Operation::set_union ? small.size() : 0;
+    result.pool.reserve(large.pool.size() + added);
+    result = large;
+    set_algebra::apply_edits(result, small, op);
+    return result;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::merged(const Set& a,
+                                      const Set& b,
+                                      set_algebra::Operation op) -> Set {
+    Set result(a.comp, a.pool.get_allocator());
+    result.assign_values(set_algebra::combine(a, b, op, &Set::split_keys));
+    return result;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::rec_dump_graphviz(index_t node,
+                                                 std::ostream& os) -> void {
+    if (node == nil) {
+        return;
+    }
+
+    const Node& current = pool[node];
+
+    if (current.parent != nil) {
+        os << std::format("  {} [label=\"{}\\nlevel={}\\nparent={}\"]\n",
+                          current.value, current.value, current.level,
+                          pool[current.parent].value);
+    } else {
+        os << std::format("  {} [label=\"{}\\nlevel={}\\nparent=(null)\"]\n",
+                          current.value, current.value, current.level);
+    }
+
+    if (current.left != nil) {
+        os << std::format("  {} -> {} [label=left]\n", current.value,
+                          pool[current.left].value);
+        rec_dump_graphviz(current.left, os);
+    }
+    if (current.right != nil) {
+        os << std::format("  {} -> {} [label=right]\n", current.value,
+                          pool[current.right].value);
+        rec_dump_graphviz(current.right, os);
+    }
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::dump_graphviz(std::ostream& os) -> void {
+    os << "digraph BST {\n";
+    rec_dump_graphviz(root, os);
+    os << "}\n";
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::begin() const -> iterator {
+    return iterator(this, leftmost);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::end() const -> iterator {
+    return iterator(this, nil);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::iterator::iterator() : set(nullptr), node(nil) {}
+
+template <typename Key, typename Compare, typename Alloc>
+Set<Key, Compare, Alloc>::iterator::iterator(const Set* set, index_t node)
+    : set(set), node(node) {}
+
+// All past-the-end iterators compare equal, like a null node pointer would
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::iterator::operator==(
+    const iterator& other) const -> bool {
+    return node == other.node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::iterator::operator++()
+    -> iterator& {  // Prefix
+    node = set->next_node(node);
+    return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::iterator::operator++(int)
+    -> iterator {  // Postfix
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::iterator::operator*() const -> const Key& {
+    // supress clang-tidy warning about possible return of null reference
+    assert(node != nil);
+    return set->pool[node].value;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::iterator::operator->() const -> const Key* {
+    return &set->pool[node].value;
+}
+
+#if defined(SET_ORDER_STATISTICS)
+template <typename Key, typename Compare, typename Alloc>
+auto Set<Key, Compare, Alloc>::iterator::position() const
+    -> difference_type {
+    // value-initialized iterators are all at the same, empty position
+    return set == nullptr ? 0 : set->position(node);
+}
+#endif
+
+template <typename Key, typename Compare, typename Alloc>
+auto operator<<(std::ostream& os, const Set<Key, Compare, Alloc>& set)
+    -> std::ostream& {
+    auto begin = set.begin();
+    auto end = set.end();
+
+    os << '{';
+    if (begin != end) {
+        os << *begin;
+        ++begin;
+    }
+
+    while (begin != end) {
+        os << ", " << *begin;
+        ++begin;
+    }
+    os << '}';
+    return os;
+}
 
-auto operator<<(std::ostream& os, const Set& set) -> std::ostream&;
+#endif
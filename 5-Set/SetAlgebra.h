@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Union, intersection and difference shared by both Set engines.
+// The engines rebuild a sorted run in O(n), so instead of joining
+// subtrees one by one the inputs are cut into key ranges, the ranges are
+// merged on separate threads and the result is built in one go.
+// When one set is much smaller, its keys are looked up in the other one
+// instead, so the work depends on the small set and not the large one.
+namespace set_algebra {
+
+enum class Operation { set_union, intersection, difference };
+
+// Below this many elements per thread, starting one costs more than it saves
+inline constexpr std::size_t min_task_size = 1 << 15;
+
+// Merges the sorted runs [a, a_end) and [b, b_end) into `out`
+template <typename It, typename Compare>
+auto merge_runs(Operation op,
+                It a,
+                It a_end,
+                It b,
+                It b_end,
+                const Compare& comp,
+                std::vector<std::iter_value_t<It>>& out) -> void {
+    while (a != a_end && b != b_end) {
+        if (comp(*a, *b)) {
+            if (op != Operation::intersection) {
+                out.push_back(*a);
+            }
+            ++a;
+        } else if (comp(*b, *a)) {
+            if (op == Operation::set_union) {
+                out.push_back(*b);
+            }
+            ++b;
+        } else {
+            if (op != Operation::difference) {
+                out.push_back(*a);
+            }
+            ++a;
+            ++b;
+        }
+    }
+
+    if (op != Operation::intersection) {
+        out.insert(out.end(), a, a_end);
+    }
+    if (op == Operation::set_union) {
+        out.insert(out.end(), b, b_end);
+    }
+}
+
+// A lookup is worth about log |large| steps of a merge
+inline auto lookups_pay(std::size_t small, std::size_t large) -> bool {
+    return small * std::bit_width(large) < large;
+}
+
+// Whether `a op b` is best made from a copy of the larger set by inserting
+// or erasing the keys of the smaller one: the copy doesn't compare keys
+// or rebalance, which a merge and a rebuild of the result both do
+template <typename SetT>
+auto by_edits(const SetT& a, const SetT& b, Operation op) -> bool {
+    if (op == Operation::set_union) {
+        return lookups_pay(std::min(a.size(), b.size()),
+                           std::max(a.size(), b.size()));
+    }
+    return op == Operation::difference && b.size() < a.size() &&
+           lookups_pay(b.size(), a.size());
+}
+
+// Turns `result`, a copy of the larger set, into `a op b` when by_edits()
+// says so; `small` is the other set
+template <typename SetT>
+auto apply_edits(SetT& result, const SetT& small, Operation op) -> void {
+    if (op == Operation::set_union) {
+        // The keys come in order, so each one usually lands right
+        // after the one before
+        auto hint = result.end();
+        for (const auto& key : small) {
+            hint = result.insert(hint, key);
+        }
+    } else {
+        for (const auto& key : small) {
+            result.erase(key);
+        }
+    }
+}
+
+// Keeps the keys of `small` that are in `large` (or that aren't, when
+// `keep_found` is false), which costs |small| log |large| instead of
+// the |small| + |large| of a merge
+template <typename SetT>
+auto filter_by_lookup(const SetT& small, const SetT& large, bool keep_found)
+    -> std::vector<typename SetT::key_type> {
+    std::vector<typename SetT::key_type> keys(small.begin(), small.end());
+    auto found = std::make_unique<bool[]>(keys.size());
+    large.contains_many(keys, {found.get(), keys.size()});
+
+    std::vector<typename SetT::key_type> out;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (found[i] == keep_found) {
+            out.push_back(std::move(keys[i]));
+        }
+    }
+    return out;
+}
+
+// Returns the sorted result of `a op b`.
+// `split_keys(set, n)` returns about n sorted keys of `set` that cut it
+// into parts of similar size; each part is merged on its own thread.
+template <typename SetT, typename SplitKeys>
+auto combine(const SetT& a, const SetT& b, Operation op, SplitKeys split_keys)
+    -> std::vector<typename SetT::key_type> {
+    using Key = typename SetT::key_type;
+    auto comp = a.key_comp();
+
+    const SetT& small = a.size() <= b.size() ? a : b;
+    const SetT& large = a.size() <= b.size() ? b : a;
+
+    bool lookups = lookups_pay(small.size(), large.size());
+    if (op == Operation::intersection && lookups) {
+        return filter_by_lookup(small, large, true);
+    }
+    if (op == Operation::difference && lookups && &small == &a) {
+        return filter_by_lookup(a, b, false);
+    }
+
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t tasks = std::clamp<std::size_t>(
+        (a.size() + b.size()) / min_task_size, 1, threads);
+
+    // Task i takes the keys in [pivots[i - 1], pivots[i])
+    std::vector<Key> candidates = std::invoke(split_keys, large, tasks - 1);
+    std::vector<Key> pivots;
+    for (std::size_t i = 1; i < tasks && !candidates.empty(); ++i) {
+        pivots.push_back(candidates[i * candidates.size() / tasks]);
+    }
+    auto duplicates = std::ranges::unique(
+        pivots, [&](const Key& x, const Key& y) { return !comp(x, y); });
+    pivots.erase(duplicates.begin(), duplicates.end());
+    tasks = pivots.size() + 1;
+
+    auto task = [&](std::size_t i) {
+        auto a_from = i == 0 ? a.begin() : a.lower_bound(pivots[i - 1]);
+        auto a_to = i == tasks - 1 ? a.end() : a.lower_bound(pivots[i]);
+        auto b_from = i == 0 ? b.begin() : b.lower_bound(pivots[i - 1]);
+        auto b_to = i == tasks - 1 ? b.end() : b.lower_bound(pivots[i]);
+
+        std::vector<Key> part;
+        merge_runs(op, a_from, a_to, b_from, b_to, comp, part);
+        return part;
+    };
+
+    // The calling thread takes the first range itself
+    std::vector<std::future<std::vector<Key>>> others;
+    for (std::size_t i = 1; i < tasks; ++i) {
+        others.push_back(std::async(std::launch::async, task, i));
+    }
+
+    std::vector<Key> out = task(0);
+    for (auto& other : others) {
+        std::vector<Key> part = other.get();
+        out.insert(out.end(), std::make_move_iterator(part.begin()),
+                   std::make_move_iterator(part.end()));
+    }
+    return out;
+}
+
+}  // namespace set_algebra
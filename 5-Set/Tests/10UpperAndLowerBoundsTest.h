@@ -1,5 +1,6 @@
 #pragma once
 #include <algorithm>
+#include <set>
 #include <vector>
 #include "../Set.h"
 #include "CustomAsserts.h"
@@ -47,6 +48,28 @@ struct UpperAndLowerBoundsTest {
 
         it = set.lower_bound(100);
         assertBool(it == set.end(), __LINE__, __FILE__);
+
+        //////////////////////////////////////////////////////////////////////////
+
+        std::set<int> expected(set.begin(), set.end());
+
+        for (int value = -1; value <= 51; ++value) {
+            auto expected_upper = expected.upper_bound(value);
+            auto upper = set.upper_bound(value);
+            if (expected_upper == expected.end()) {
+                assertBool(upper == set.end(), __LINE__, __FILE__);
+            } else {
+                assertEqual(*upper, *expected_upper, __LINE__, __FILE__);
+            }
+
+            auto expected_lower = expected.lower_bound(value);
+            auto lower = set.lower_bound(value);
+            if (expected_lower == expected.end()) {
+                assertBool(lower == set.end(), __LINE__, __FILE__);
+            } else {
+                assertEqual(*lower, *expected_lower, __LINE__, __FILE__);
+            }
+        }
     }
 };
 
@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct NodeReuseTest {
+    NodeReuseTest() {
+        Set set;
+
+        // iterators have to survive the node pool growing underneath them
+        auto first = set.insert(0).first;
+        for (int i = 1; i < 1000; ++i) {
+            set.insert(i);
+        }
+        assertEqual(*first, 0, __LINE__, __FILE__);
+        assertBool(first == set.begin(), __LINE__, __FILE__);
+
+        // erased slots get reused by later insertions
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 1000; i += 2) {
+                set.erase(i);
+            }
+            assertEqual(set.size(), 500u, __LINE__, __FILE__);
+
+            for (int i = 0; i < 1000; i += 2) {
+                set.insert(i);
+            }
+            assertEqual(set.size(), 1000u, __LINE__, __FILE__);
+        }
+
+        int expected = 0;
+        for (int value : set) {
+            assertEqual(value, expected++, __LINE__, __FILE__);
+        }
+        assertEqual(expected, 1000, __LINE__, __FILE__);
+
+        Set copy = set;
+        for (int i = 0; i < 1000; i += 3) {
+            copy.erase(i);
+        }
+        assertEqual(set.size(), 1000u, __LINE__, __FILE__);
+        assertEqual(copy.size(), 666u, __LINE__, __FILE__);
+        assertBool(copy.contains(1) && !copy.contains(3), __LINE__, __FILE__);
+    }
+};
+
+static NodeReuseTest nodeReuseTest;
+}  // namespace test
@@ -0,0 +1,45 @@
+#pragma once
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct BulkLoadTest {
+    BulkLoadTest() {
+        std::vector<int> sorted(10000);
+        std::iota(sorted.begin(), sorted.end(), -5000);
+
+        Set set(sorted.begin(), sorted.end());
+        assertEqual(set.size(), sorted.size(), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(set, sorted), __LINE__, __FILE__);
+
+        // the built tree has to keep working as a regular one
+        for (int value = -5000; value < 5000; value += 2) {
+            set.erase(value);
+        }
+        for (int value = 5000; value < 6000; ++value) {
+            set.insert(value);
+        }
+        assertEqual(set.size(), 6000u, __LINE__, __FILE__);
+        assertEqual(*set.begin(), -4999, __LINE__, __FILE__);
+        assertEqual(*set.lower_bound(4998), 4999, __LINE__, __FILE__);
+
+        std::vector<int> unsorted{5, 3, 9, 3, 1, 5, 7, 9, 9};
+        set.assign(unsorted.begin(), unsorted.end());
+        assertEqual(set.size(), 5u, __LINE__, __FILE__);
+        assertBool(set == Set{1, 3, 5, 7, 9}, __LINE__, __FILE__);
+
+        std::vector<int> empty;
+        set.assign(empty.begin(), empty.end());
+        assertBool(set.empty(), __LINE__, __FILE__);
+        assertBool(set.begin() == set.end(), __LINE__, __FILE__);
+
+        set.insert(42);
+        assertEqual(*set.begin(), 42, __LINE__, __FILE__);
+    }
+};
+
+static BulkLoadTest bulkLoadTest;
+}  // namespace test
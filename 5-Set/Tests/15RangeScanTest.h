@@ -0,0 +1,68 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct RangeScanTest {
+    RangeScanTest() {
+        Set set;
+        for (int i = 0; i < 1000; ++i) {
+            set.insert(i * 3);
+        }
+
+        std::vector<int> out(100);
+
+        std::size_t n = set.scan(10, 40, out);
+        std::vector<int> expected{12, 15, 18, 21, 24, 27, 30, 33, 36, 39};
+        assertEqual(n, expected.size(), __LINE__, __FILE__);
+        assertBool(std::equal(expected.begin(), expected.end(), out.begin()),
+                   __LINE__, __FILE__);
+
+        n = set.scan(-100, -1, out);
+        assertEqual(n, 0u, __LINE__, __FILE__);
+
+        // an inverted range is empty, not a read past the end
+        n = set.scan(500, 10, out);
+        assertEqual(n, 0u, __LINE__, __FILE__);
+        n = set.scan(2998, 0, out);
+        assertEqual(n, 0u, __LINE__, __FILE__);
+        n = set.scan(30, 30, out);
+        assertEqual(n, 1u, __LINE__, __FILE__);
+        assertEqual(out[0], 30, __LINE__, __FILE__);
+
+        n = set.scan(2997, 100000, out);
+        assertEqual(n, 1u, __LINE__, __FILE__);
+        assertEqual(out[0], 2997, __LINE__, __FILE__);
+
+        // a small buffer gets filled chunk by chunk
+        std::array<int, 7> chunk;
+        std::vector<int> streamed;
+        int from = 0;
+        while ((n = set.scan(from, 1500, chunk)) > 0) {
+            streamed.insert(streamed.end(), chunk.begin(), chunk.begin() + n);
+            from = chunk[n - 1] + 1;
+        }
+        assertEqual(streamed.size(), 501u, __LINE__, __FILE__);
+        for (std::size_t i = 0; i < streamed.size(); ++i) {
+            assertEqual(streamed[i], static_cast<int>(i * 3), __LINE__,
+                        __FILE__);
+        }
+
+        // iteration order survives erasures in the middle of the tree
+        for (int i = 0; i < 3000; i += 6) {
+            set.erase(i);
+        }
+        int expected_value = 3;
+        for (int value : set) {
+            assertEqual(value, expected_value, __LINE__, __FILE__);
+            expected_value += 6;
+        }
+        assertEqual(expected_value, 3003, __LINE__, __FILE__);
+    }
+};
+
+static RangeScanTest rangeScanTest;
+}  // namespace test
@@ -0,0 +1,52 @@
+#pragma once
+#include <memory>
+#include <random>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct BatchLookupTest {
+    BatchLookupTest() {
+        Set set;
+        std::vector<int> keys;
+
+        // nothing to find in an empty set, and no keys is fine too
+        keys = {1, 2, 3};
+        auto found = std::make_unique<bool[]>(keys.size());
+        set.contains_many(keys, {found.get(), keys.size()});
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            assertBool(!found[i], __LINE__, __FILE__);
+        }
+        set.contains_many({}, {});
+
+        std::mt19937 rng(16);
+        std::uniform_int_distribution<int> dist(0, 4000);
+        for (int i = 0; i < 1000; ++i) {
+            set.insert(dist(rng));
+        }
+
+        // more keys than one batch, with hits, misses and repeats
+        keys.clear();
+        for (int i = 0; i < 1237; ++i) {
+            keys.push_back(dist(rng) - 100);
+        }
+        keys.push_back(keys.front());
+
+        found = std::make_unique<bool[]>(keys.size());
+        std::vector<Set<int>::iterator> iterators(keys.size());
+        set.contains_many(keys, {found.get(), keys.size()});
+        set.find_many(keys, iterators);
+
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            assertEqual(found[i], set.contains(keys[i]), __LINE__, __FILE__);
+            assertBool(iterators[i] == set.find(keys[i]), __LINE__, __FILE__);
+            if (found[i]) {
+                assertEqual(*iterators[i], keys[i], __LINE__, __FILE__);
+            }
+        }
+    }
+};
+
+static BatchLookupTest batchLookupTest;
+}  // namespace test
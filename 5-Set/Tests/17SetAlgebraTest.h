@@ -0,0 +1,112 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct SetAlgebraTest {
+    struct CountingLess {
+        static inline std::size_t comparisons = 0;
+
+        auto operator()(int a, int b) const -> bool {
+            ++comparisons;
+            return a < b;
+        }
+    };
+
+    SetAlgebraTest() {
+        Set a{1, 2, 3, 5, 8};
+        Set b{2, 3, 4, 8, 9};
+
+        assertBool(set_union(a, b) == Set{1, 2, 3, 4, 5, 8, 9}, __LINE__,
+                   __FILE__);
+        assertBool(set_intersection(a, b) == Set{2, 3, 8}, __LINE__,
+                   __FILE__);
+        assertBool(set_difference(a, b) == Set{1, 5}, __LINE__, __FILE__);
+        assertBool(set_difference(b, a) == Set{4, 9}, __LINE__, __FILE__);
+
+        Set empty;
+        assertBool(set_union(a, empty) == a, __LINE__, __FILE__);
+        assertBool(set_intersection(empty, b).empty(), __LINE__, __FILE__);
+        assertBool(set_difference(a, empty) == a, __LINE__, __FILE__);
+        assertBool(set_difference(a, a).empty(), __LINE__, __FILE__);
+
+        // big enough to be merged on several threads, and a small set
+        // that is looked up in a big one instead of merged with it
+        std::mt19937 rng(17);
+        std::uniform_int_distribution<int> dist(0, 1 << 20);
+        std::vector<int> big_keys;
+        std::vector<int> other_keys;
+        std::vector<int> small_keys;
+        for (int i = 0; i < 100000; ++i) {
+            big_keys.push_back(dist(rng));
+            other_keys.push_back(dist(rng));
+        }
+        for (int i = 0; i < 100; ++i) {
+            small_keys.push_back(dist(rng));
+            small_keys.push_back(big_keys[i]);
+        }
+
+        std::vector<std::vector<int>> inputs{big_keys, other_keys, small_keys};
+        for (auto& keys : inputs) {
+            std::ranges::sort(keys);
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        }
+
+        for (const auto& x : inputs) {
+            for (const auto& y : inputs) {
+                Set sx(x.begin(), x.end());
+                Set sy(y.begin(), y.end());
+                std::vector<int> expected;
+
+                std::ranges::set_union(x, y, std::back_inserter(expected));
+                assertBool(std::ranges::equal(set_union(sx, sy), expected),
+                           __LINE__, __FILE__);
+
+                expected.clear();
+                std::ranges::set_intersection(x, y,
+                                              std::back_inserter(expected));
+                assertBool(
+                    std::ranges::equal(set_intersection(sx, sy), expected),
+                    __LINE__, __FILE__);
+
+                expected.clear();
+                std::ranges::set_difference(x, y,
+                                            std::back_inserter(expected));
+                assertBool(
+                    std::ranges::equal(set_difference(sx, sy), expected),
+                    __LINE__, __FILE__);
+            }
+        }
+
+        // A few keys go into a copy of the big set instead of being merged
+        // with it, so the comparisons follow the small set
+        const auto& x = inputs[0];
+        const auto& y = inputs[2];
+        Set<int, CountingLess> huge(x.begin(), x.end());
+        Set<int, CountingLess> tiny(y.begin(), y.end());
+        std::vector<int> expected;
+
+        CountingLess::comparisons = 0;
+        Set<int, CountingLess> both = set_union(tiny, huge);
+        assertBool(CountingLess::comparisons < huge.size() / 4, __LINE__,
+                   __FILE__);
+        std::ranges::set_union(x, y, std::back_inserter(expected));
+        assertBool(std::ranges::equal(both, expected), __LINE__, __FILE__);
+
+        CountingLess::comparisons = 0;
+        Set<int, CountingLess> rest = set_difference(huge, tiny);
+        assertBool(CountingLess::comparisons < huge.size() / 4, __LINE__,
+                   __FILE__);
+        expected.clear();
+        std::ranges::set_difference(x, y, std::back_inserter(expected));
+        assertBool(std::ranges::equal(rest, expected), __LINE__, __FILE__);
+    }
+};
+
+static SetAlgebraTest setAlgebraTest;
+}  // namespace test
@@ -0,0 +1,64 @@
+#pragma once
+#include <iterator>
+#include <random>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct OrderStatisticsTest {
+    OrderStatisticsTest() {
+        Set set;
+        assertBool(set.nth(0) == set.end(), __LINE__, __FILE__);
+        assertEqual(set.rank(5), 0u, __LINE__, __FILE__);
+        assertEqual(std::ranges::distance(set.begin(), set.end()), 0,
+                    __LINE__, __FILE__);
+
+        // mixed insertions and erasures, so the sizes go through
+        // every kind of rotation and both kinds of unlinking
+        std::mt19937 rng(18);
+        std::uniform_int_distribution<int> dist(0, 3000);
+        for (int round = 0; round < 4000; ++round) {
+            int value = dist(rng);
+            if (round % 3 == 2) {
+                set.erase(value);
+            } else {
+                set.insert(value);
+            }
+        }
+
+        std::vector<int> values(set.begin(), set.end());
+        for (std::size_t k = 0; k < values.size(); ++k) {
+            assertEqual(*set.nth(k), values[k], __LINE__, __FILE__);
+        }
+        assertBool(set.nth(values.size()) == set.end(), __LINE__, __FILE__);
+
+        for (int value = -1; value <= 3001; ++value) {
+            std::size_t expected =
+                std::lower_bound(values.begin(), values.end(), value) -
+                values.begin();
+            assertEqual(set.rank(value), expected, __LINE__, __FILE__);
+        }
+
+        auto middle = set.nth(values.size() / 2);
+        assertEqual(std::ranges::distance(set.begin(), set.end()),
+                    static_cast<std::ptrdiff_t>(values.size()), __LINE__,
+                    __FILE__);
+        assertEqual(middle - set.begin(),
+                    static_cast<std::ptrdiff_t>(values.size() / 2), __LINE__,
+                    __FILE__);
+        assertEqual(set.begin() - middle,
+                    -static_cast<std::ptrdiff_t>(values.size() / 2), __LINE__,
+                    __FILE__);
+
+        // bulk-built trees and copies carry their sizes along
+        Set built(values.begin(), values.end());
+        Set copy = built;
+        for (std::size_t k = 0; k < values.size(); k += 7) {
+            assertEqual(*copy.nth(k), values[k], __LINE__, __FILE__);
+        }
+    }
+};
+
+static OrderStatisticsTest orderStatisticsTest;
+}  // namespace test
@@ -0,0 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct GenericKeysTest {
+    GenericKeysTest() {
+        // keys that don't fit in an int, kept in descending order
+        Set<std::uint64_t, std::greater<std::uint64_t>> big;
+        std::set<std::uint64_t, std::greater<std::uint64_t>> big_expected;
+        for (std::uint64_t i = 0; i < 5000; ++i) {
+            std::uint64_t key = (i * 2654435761u) % 7919 + (1ull << 40);
+            big.insert(key);
+            big_expected.insert(key);
+        }
+        for (std::uint64_t i = 0; i < 7919; i += 3) {
+            big.erase(i + (1ull << 40));
+            big_expected.erase(i + (1ull << 40));
+        }
+        assertBool(std::ranges::equal(big, big_expected), __LINE__, __FILE__);
+        assertBool(big.size() == big_expected.size(), __LINE__, __FILE__);
+        assertBool(*big.begin() == *big_expected.begin(), __LINE__, __FILE__);
+        for (std::uint64_t i = 100; i < 7919; i += 100) {
+            std::uint64_t key = i + (1ull << 40);
+            assertBool(*big.lower_bound(key) == *big_expected.lower_bound(key),
+                       __LINE__, __FILE__);
+        }
+        assertBool(big.lower_bound(1) == big.end(), __LINE__, __FILE__);
+
+        // keys that own memory, found by string_view without a conversion
+        Set<std::string, std::less<>> words;
+        std::set<std::string> words_expected;
+        for (int i = 0; i < 2000; ++i) {
+            std::string word = "word-" + std::to_string(i * 7 % 2000);
+            words.insert(std::string(word));
+            words_expected.insert(word);
+        }
+        for (int i = 0; i < 2000; i += 2) {
+            words.erase("word-" + std::to_string(i));
+            words_expected.erase("word-" + std::to_string(i));
+        }
+        assertBool(std::ranges::equal(words, words_expected), __LINE__,
+                   __FILE__);
+
+        std::string_view present = "word-1999";
+        std::string_view absent = "word-1998";
+        assertBool(words.contains(present), __LINE__, __FILE__);
+        assertBool(!words.contains(absent), __LINE__, __FILE__);
+        assertBool(*words.find(present) == present, __LINE__, __FILE__);
+        assertBool(words.find(absent) == words.end(), __LINE__, __FILE__);
+        assertBool(*words.upper_bound(absent) == present, __LINE__, __FILE__);
+
+        Set<std::string, std::less<>> copy = words;
+        copy.insert("extra");
+        assertBool(copy.size() == words.size() + 1, __LINE__, __FILE__);
+        assertBool(set_difference(copy, words) ==
+                       Set<std::string, std::less<>>{"extra"},
+                   __LINE__, __FILE__);
+
+        std::vector<std::string> keys{"word-1", "word-2", "word-3"};
+        bool found[3];
+        words.contains_many(keys, found);
+        assertBool(found[0] && !found[1] && found[2], __LINE__, __FILE__);
+    }
+};
+
+static GenericKeysTest genericKeysTest;
+}  // namespace test
@@ -0,0 +1,172 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../../Common/ContainerStats.h"
+#include "../ConcurrentSet.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct ConcurrentSetTest {
+    struct CountingLess {
+        static inline std::size_t comparisons = 0;
+
+        auto operator()(int a, int b) const -> bool {
+            ++comparisons;
+            return a < b;
+        }
+    };
+
+    ConcurrentSetTest() {
+        // On one thread it's just a set
+        ConcurrentSet<int> set{5, 1, 3};
+        std::set<int> expected{5, 1, 3};
+        std::mt19937 rng(20);
+        std::uniform_int_distribution<int> dist(0, 2000);
+        for (int i = 0; i < 20000; ++i) {
+            int key = dist(rng);
+            if (i % 3 == 0) {
+                assertEqual(set.erase(key), expected.erase(key), __LINE__,
+                            __FILE__);
+            } else {
+                assertEqual(set.insert(key), expected.insert(key).second,
+                            __LINE__, __FILE__);
+            }
+        }
+        assertEqual(set.size(), expected.size(), __LINE__, __FILE__);
+
+        std::vector<int> keys;
+        set.for_each([&](int key) { keys.push_back(key); });
+        assertBool(std::ranges::equal(keys, expected), __LINE__, __FILE__);
+
+        for (int key = -1; key <= 2001; ++key) {
+            auto lower = expected.lower_bound(key);
+            auto upper = expected.upper_bound(key);
+            assertBool(set.contains(key) == expected.contains(key), __LINE__,
+                       __FILE__);
+            assertBool(set.lower_bound(key) ==
+                           (lower == expected.end() ? std::nullopt
+                                                    : std::optional(*lower)),
+                       __LINE__, __FILE__);
+            assertBool(set.upper_bound(key) ==
+                           (upper == expected.end() ? std::nullopt
+                                                    : std::optional(*upper)),
+                       __LINE__, __FILE__);
+        }
+
+        // The even keys stay put while the writer churns the odd ones,
+        // so every reader must keep finding all of them
+        constexpr int range = 4096;
+        ConcurrentSet<int> shared;
+        for (int key = 0; key < range; key += 2) {
+            shared.insert(key);
+        }
+
+        std::atomic<bool> writing = true;
+        std::atomic<bool> failed = false;
+
+        auto reader = [&](int seed) {
+            std::mt19937 rng(seed);
+            // below the largest even key, so there's always a next one
+            std::uniform_int_distribution<int> dist(0, range / 2 - 2);
+            // check at least once more after the writer is done
+            bool last_round = false;
+            while (!last_round) {
+                last_round = !writing;
+                for (int i = 0; i < 1000; ++i) {
+                    int even = dist(rng) * 2;
+                    auto next = shared.upper_bound(even);
+                    if (!shared.contains(even) || !next ||
+                        *next > even + 2) {
+                        failed = true;
+                    }
+                }
+
+                int previous = -1;
+                int evens = 0;
+                shared.for_each([&](int key) {
+                    failed = failed || key <= previous;
+                    evens += key % 2 == 0;
+                    previous = key;
+                });
+                failed = failed || evens != range / 2;
+            }
+        };
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 3; ++i) {
+            readers.emplace_back(reader, i);
+        }
+
+        std::uniform_int_distribution<int> odd(0, range / 2 - 1);
+        for (int i = 0; i < 50000; ++i) {
+            int key = odd(rng) * 2 + 1;
+            if (i % 2 == 0) {
+                shared.insert(key);
+            } else {
+                shared.erase(key);
+            }
+        }
+        writing = false;
+
+        for (auto& thread : readers) {
+            thread.join();
+        }
+        assertBool(!failed, __LINE__, __FILE__);
+
+        // A for_each callback can write to the set it walks: the writes
+        // don't wait for the for_each to finish, and what it held back
+        // is freed by the writes after it
+        using Allocator = container_stats::CountingAllocator<int>;
+        container_stats::Stats stats;
+        ConcurrentSet<int, std::less<int>, Allocator> nested(
+            std::less<int>{}, Allocator(stats));
+        for (int key = 0; key < 1000; ++key) {
+            nested.insert(key);
+        }
+        int next = 0;
+        nested.for_each([&](int key) {
+            assertEqual(key, next++, __LINE__, __FILE__);
+            nested.erase(key);
+            nested.insert(key + 1000);
+        });
+        assertEqual(next, 1000, __LINE__, __FILE__);
+        assertEqual(nested.size(), std::size_t(1000), __LINE__, __FILE__);
+        assertBool(!nested.contains(999) && nested.contains(1999), __LINE__,
+                   __FILE__);
+
+        for (int key = 1000; key < 2000; ++key) {
+            nested.erase(key);
+            nested.insert(key);
+        }
+        assertBool(std::size_t(stats.live_blocks) < nested.size() + 3000,
+                   __LINE__, __FILE__);
+
+        // An insert copies the nodes it passes and makes one more, and
+        // rebalancing changes those copies instead of copying them again.
+        // A lookup of a missing key passes the same nodes, two
+        // comparisons each.
+        container_stats::Stats copies;
+        ConcurrentSet<int, CountingLess, Allocator> balanced(
+            CountingLess{}, Allocator(copies));
+        for (int i = 0; i < 5000; ++i) {
+            int key = i % 2 == 0 ? i : dist(rng) * 4;
+            CountingLess::comparisons = 0;
+            if (balanced.contains(key)) {
+                continue;
+            }
+            std::size_t passed = CountingLess::comparisons / 2;
+            std::size_t allocations = copies.allocations;
+            balanced.insert(key);
+            assertEqual(copies.allocations - allocations, passed + 1,
+                        __LINE__, __FILE__);
+        }
+    }
+};
+
+static ConcurrentSetTest concurrentSetTest;
+}  // namespace test
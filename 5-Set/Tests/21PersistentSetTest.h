@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../PersistentSet.h"
+#include "CustomAsserts.h"
+
+namespace test {
+// Counts the nodes a set allocates, to see how much a change copies
+template <typename T>
+struct NodeCountingAllocator {
+    using value_type = T;
+
+    static inline std::size_t allocated = 0;
+
+    NodeCountingAllocator() = default;
+    template <typename U>
+    NodeCountingAllocator(const NodeCountingAllocator<U>&) {}
+
+    auto allocate(std::size_t n) -> T* {
+        allocated += n;
+        return std::allocator<T>().allocate(n);
+    }
+    auto deallocate(T* p, std::size_t n) -> void {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    auto operator==(const NodeCountingAllocator<U>&) const -> bool {
+        return true;
+    }
+};
+
+struct PersistentSetTest {
+    PersistentSetTest() {
+        // Every snapshot keeps what it saw, whatever happens to the others
+        PersistentSet<int> set{5, 1, 3};
+        std::set<int> expected{5, 1, 3};
+        std::vector<std::pair<PersistentSet<int>, std::set<int>>> snapshots;
+        std::mt19937 rng(21);
+        std::uniform_int_distribution<int> dist(0, 2000);
+        for (int i = 0; i < 20000; ++i) {
+            int key = dist(rng);
+            if (i % 3 == 0) {
+                assertEqual(set.erase(key), expected.erase(key), __LINE__,
+                            __FILE__);
+            } else {
+                assertEqual(set.insert(key), expected.insert(key).second,
+                            __LINE__, __FILE__);
+            }
+            if (i % 1000 == 0) {
+                snapshots.emplace_back(set, expected);
+                assertBool(snapshots.back().first.shares_with(set), __LINE__,
+                           __FILE__);
+            }
+        }
+        assertEqual(set.size(), expected.size(), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(set, expected), __LINE__, __FILE__);
+        for (auto& [snapshot, snapshot_expected] : snapshots) {
+            assertEqual(snapshot.size(), snapshot_expected.size(), __LINE__,
+                        __FILE__);
+            assertBool(std::ranges::equal(snapshot, snapshot_expected),
+                       __LINE__, __FILE__);
+        }
+
+        for (int key = -1; key <= 2001; ++key) {
+            auto lower = expected.lower_bound(key);
+            auto upper = expected.upper_bound(key);
+            auto found = set.find(key);
+            assertBool(set.contains(key) == expected.contains(key), __LINE__,
+                       __FILE__);
+            assertBool(expected.contains(key) ? *found == key
+                                              : found == set.end(),
+                       __LINE__, __FILE__);
+            assertBool(lower == expected.end()
+                           ? set.lower_bound(key) == set.end()
+                           : *set.lower_bound(key) == *lower,
+                       __LINE__, __FILE__);
+            assertBool(upper == expected.end()
+                           ? set.upper_bound(key) == set.end()
+                           : *set.upper_bound(key) == *upper,
+                       __LINE__, __FILE__);
+        }
+        assertBool(std::ranges::equal(set.lower_bound(1000), set.end(),
+                                      expected.lower_bound(1000),
+                                      expected.end()),
+                   __LINE__, __FILE__);
+
+        // A snapshot allocates nothing, a change copies about one path
+        using CountedSet =
+            PersistentSet<int, std::less<int>, NodeCountingAllocator<int>>;
+        CountedSet big;
+        for (int key = 0; key < 100000; key += 2) {
+            big.insert(key);
+        }
+        std::size_t before = NodeCountingAllocator<int>::allocated;
+        CountedSet copy = big;
+        assertEqual(NodeCountingAllocator<int>::allocated, before, __LINE__,
+                    __FILE__);
+
+        copy.insert(50001);
+        copy.erase(20000);
+        copy.insert(0);
+        assertBool(NodeCountingAllocator<int>::allocated - before <= 80,
+                   __LINE__, __FILE__);
+        assertBool(!copy.shares_with(big), __LINE__, __FILE__);
+        assertBool(copy.contains(50001) && !big.contains(50001), __LINE__,
+                   __FILE__);
+        assertBool(!copy.contains(20000) && big.contains(20000), __LINE__,
+                   __FILE__);
+        assertEqual(big.size(), std::size_t(50000), __LINE__, __FILE__);
+
+        // Once nothing else shares them, the nodes change in place
+        big = CountedSet();
+        before = NodeCountingAllocator<int>::allocated;
+        copy.erase(50001);
+        copy.erase(30000);
+        assertEqual(NodeCountingAllocator<int>::allocated, before, __LINE__,
+                    __FILE__);
+
+        // Copies go their own way on other threads
+        PersistentSet<int> base;
+        for (int key = 0; key < 4096; ++key) {
+            base.insert(key);
+        }
+        std::vector<std::thread> threads;
+        std::array<bool, 4> intact{};
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&intact, copy = base, t]() mutable {
+                for (int key = t; key < 4096; key += 4) {
+                    copy.erase(key);
+                }
+                intact[t] = copy.size() == 3072 && !copy.contains(t) &&
+                            copy.contains(t + 1);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assertBool(std::ranges::all_of(intact, std::identity()), __LINE__,
+                   __FILE__);
+        assertEqual(base.size(), std::size_t(4096), __LINE__, __FILE__);
+    }
+};
+
+static PersistentSetTest persistentSetTest;
+}  // namespace test
@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include "../FrozenSetFile.h"
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct FrozenSetTest {
+    template <typename Exception, typename F>
+    static auto throws(F&& f) -> bool {
+        try {
+            f();
+        } catch (const Exception&) {
+            return true;
+        }
+        return false;
+    }
+
+    FrozenSetTest() {
+        Set<int> set;
+        std::mt19937 rng(22);
+        std::uniform_int_distribution<int> dist(-50000, 50000);
+        for (int i = 0; i < 20000; ++i) {
+            set.insert(dist(rng));
+        }
+
+        auto path = std::filesystem::temp_directory_path() /
+                    ("ds-frozen-set-test-" + std::to_string(getpid()));
+        {
+            std::ofstream out(path, std::ios::binary);
+            FrozenSet<int>::save(set, out);
+        }
+        assertEqual(std::filesystem::file_size(path),
+                    64 + set.size() * sizeof(int), __LINE__, __FILE__);
+
+        // Both ways back give the same set, and it answers like the original
+        std::stringstream stream;
+        FrozenSet<int>::save(set, stream);
+        FrozenSet<int> loaded = FrozenSet<int>::load(stream);
+        FrozenSet<int> mapped = FrozenSet<int>::open(path.string());
+        std::filesystem::remove(path);
+
+        for (const FrozenSet<int>* frozen : {&loaded, &mapped}) {
+            assertEqual(frozen->size(), set.size(), __LINE__, __FILE__);
+            assertBool(std::ranges::equal(*frozen, set), __LINE__, __FILE__);
+
+            for (int key = -50010; key <= 50010; key += 7) {
+                auto lower = set.lower_bound(key);
+                auto upper = set.upper_bound(key);
+                assertBool(frozen->contains(key) == set.contains(key),
+                           __LINE__, __FILE__);
+                assertBool(frozen->find(key) == frozen->end()
+                               ? !set.contains(key)
+                               : *frozen->find(key) == key,
+                           __LINE__, __FILE__);
+                assertBool(lower == set.end()
+                               ? frozen->lower_bound(key) == frozen->end()
+                               : *frozen->lower_bound(key) == *lower,
+                           __LINE__, __FILE__);
+                assertBool(upper == set.end()
+                               ? frozen->upper_bound(key) == frozen->end()
+                               : *frozen->upper_bound(key) == *upper,
+                           __LINE__, __FILE__);
+            }
+        }
+
+        // A frozen set saves itself, even an empty one
+        std::stringstream again;
+        mapped.save(again);
+        assertBool(std::ranges::equal(FrozenSet<int>::load(again), set),
+                   __LINE__, __FILE__);
+        std::stringstream nothing;
+        FrozenSet<int>().save(nothing);
+        assertBool(FrozenSet<int>::load(nothing).empty(), __LINE__, __FILE__);
+
+        // Files that don't hold what's asked for are refused
+        std::stringstream wide;
+        FrozenSet<int>::save(set, wide);
+        assertBool(throws<std::runtime_error>(
+                       [&] { FrozenSet<std::int64_t>::load(wide); }),
+                   __LINE__, __FILE__);
+
+        std::string bytes = stream.str();
+        std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+        assertBool(throws<std::runtime_error>(
+                       [&] { FrozenSet<int>::load(truncated); }),
+                   __LINE__, __FILE__);
+        std::stringstream garbage(std::string(100, 'x'));
+        assertBool(throws<std::runtime_error>(
+                       [&] { FrozenSet<int>::load(garbage); }),
+                   __LINE__, __FILE__);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << bytes.substr(0, bytes.size() - 4);
+        }
+        assertBool(throws<std::runtime_error>(
+                       [&] { FrozenSet<int>::open(path.string()); }),
+                   __LINE__, __FILE__);
+        std::filesystem::remove(path);
+
+        // Nor is a count so large that the size it works out to wraps
+        // around to what the file holds
+        std::string huge = bytes.substr(0, 64);
+        std::uint64_t count = std::uint64_t(1) << 62;
+        std::memcpy(huge.data() + 16, &count, sizeof(count));
+        std::stringstream huge_stream(huge);
+        assertBool(throws<std::runtime_error>(
+                       [&] { FrozenSet<int>::load(huge_stream); }),
+                   __LINE__, __FILE__);
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << huge;
+        }
+        assertBool(throws<std::runtime_error>(
+                       [&] { FrozenSet<int>::open(path.string()); }),
+                   __LINE__, __FILE__);
+        std::filesystem::remove(path);
+
+        assertBool(throws<std::system_error>(
+                       [&] { FrozenSet<int>::open(path.string()); }),
+                   __LINE__, __FILE__);
+    }
+};
+
+static FrozenSetTest frozenSetTest;
+}  // namespace test
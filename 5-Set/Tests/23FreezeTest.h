@@ -0,0 +1,86 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include "../FrozenSet.h"
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct FreezeTest {
+    // The frozen set holds the same keys and finds the same bounds
+    template <typename SetT, typename Frozen>
+    static auto check_same(const SetT& set, const Frozen& frozen, int from,
+                           int to) -> void {
+        assertEqual(frozen.size(), set.size(), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(frozen, set), __LINE__, __FILE__);
+
+        for (int key = from; key <= to; ++key) {
+            auto lower = set.lower_bound(key);
+            auto upper = set.upper_bound(key);
+            assertBool(frozen.contains(key) == set.contains(key), __LINE__,
+                       __FILE__);
+            assertBool(frozen.find(key) == frozen.end()
+                           ? !set.contains(key)
+                           : *frozen.find(key) == key,
+                       __LINE__, __FILE__);
+            assertBool(lower == set.end()
+                           ? frozen.lower_bound(key) == frozen.end()
+                           : *frozen.lower_bound(key) == *lower,
+                       __LINE__, __FILE__);
+            assertBool(upper == set.end()
+                           ? frozen.upper_bound(key) == frozen.end()
+                           : *frozen.upper_bound(key) == *upper,
+                       __LINE__, __FILE__);
+        }
+    }
+
+    FreezeTest() {
+        // Every shape of the last level, from no keys to a few thousand
+        std::mt19937 rng(23);
+        for (int n : {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 1000, 4097}) {
+            Set<int> set;
+            std::uniform_int_distribution<int> dist(-3 * n, 3 * n);
+            while (static_cast<int>(set.size()) < n) {
+                set.insert(dist(rng));
+            }
+            check_same(set, set.freeze(), -3 * n - 2, 3 * n + 2);
+        }
+
+        Set<std::int64_t, std::greater<std::int64_t>> descending;
+        for (std::int64_t key = 0; key < 3000; key += 3) {
+            descending.insert(key);
+        }
+        check_same(descending, descending.freeze(), -5, 3005);
+
+        // Saved and loaded in its own layout, not mistaken for the other
+        Set<int> set{9, 2, 7, 4, 5, 1, 8};
+        std::stringstream stream;
+        set.freeze().save(stream);
+        std::string bytes = stream.str();
+        assertEqual(bytes.size(), 64 + (set.size() + 1) * sizeof(int),
+                    __LINE__, __FILE__);
+        using Eytzinger = FrozenSet<int, std::less<int>,
+                                    FrozenLayout::eytzinger>;
+        check_same(set, Eytzinger::load(stream), -1, 11);
+
+        std::stringstream direct;
+        Eytzinger::save(set, direct);
+        assertBool(direct.str() == bytes, __LINE__, __FILE__);
+
+        std::stringstream wrong_layout(bytes);
+        bool refused = false;
+        try {
+            FrozenSet<int>::load(wrong_layout);
+        } catch (const std::runtime_error&) {
+            refused = true;
+        }
+        assertBool(refused, __LINE__, __FILE__);
+    }
+};
+
+static FreezeTest freezeTest;
+}  // namespace test
@@ -0,0 +1,66 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include "../KeySearch.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct KeySearchTest {
+    // Each version this machine can run agrees with std::lower_bound and
+    // std::upper_bound, whatever the block size and wherever the value is
+    KeySearchTest() {
+        namespace detail = key_search::detail;
+        std::mt19937 rng(24);
+        std::uniform_int_distribution<int> dist(-100, 100);
+
+        for (int n = 0; n <= 70; ++n) {
+            std::vector<int> keys(n);
+            for (int& key : keys) {
+                key = dist(rng);
+            }
+            std::ranges::sort(keys);
+
+            std::vector<int> values{std::numeric_limits<int>::min(),
+                                    std::numeric_limits<int>::max()};
+            for (int value = -102; value <= 102; ++value) {
+                values.push_back(value);
+            }
+
+            for (int value : values) {
+                int less = static_cast<int>(
+                    std::ranges::lower_bound(keys, value) - keys.begin());
+                int less_equal = static_cast<int>(
+                    std::ranges::upper_bound(keys, value) - keys.begin());
+                const int* data = keys.data();
+
+                assertEqual(detail::count_less_scalar(data, n, value), less,
+                            __LINE__, __FILE__);
+                assertEqual(detail::count_less_equal_scalar(data, n, value),
+                            less_equal, __LINE__, __FILE__);
+                assertEqual(key_search::count_less(data, n, value), less,
+                            __LINE__, __FILE__);
+                assertEqual(key_search::count_less_equal(data, n, value),
+                            less_equal, __LINE__, __FILE__);
+#if defined(__SSE2__)
+                assertEqual(detail::count_less_sse2(data, n, value), less,
+                            __LINE__, __FILE__);
+                assertEqual(detail::count_less_equal_sse2(data, n, value),
+                            less_equal, __LINE__, __FILE__);
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+                if (detail::has_avx2) {
+                    assertEqual(detail::count_less_avx2(data, n, value), less,
+                                __LINE__, __FILE__);
+                    assertEqual(detail::count_less_equal_avx2(data, n, value),
+                                less_equal, __LINE__, __FILE__);
+                }
+#endif
+            }
+        }
+    }
+};
+
+static KeySearchTest keySearchTest;
+}  // namespace test
@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct HintedInsertTest {
+    struct CountingLess {
+        static inline std::size_t comparisons = 0;
+
+        auto operator()(int a, int b) const -> bool {
+            ++comparisons;
+            return a < b;
+        }
+    };
+
+    HintedInsertTest() {
+        constexpr int n = 10000;
+        std::vector<int> sequence(n);
+        for (int i = 0; i < n; ++i) {
+            sequence[i] = i;
+        }
+
+        // Appending with end() or with the last insertion as the hint
+        // takes a few comparisons per key, not a descent
+        Set<int, CountingLess> appended;
+        CountingLess::comparisons = 0;
+        for (int i = 0; i < n; ++i) {
+            auto it = appended.insert(appended.end(), i);
+            assertEqual(*it, i, __LINE__, __FILE__);
+        }
+        assertBool(CountingLess::comparisons <= 3 * n, __LINE__, __FILE__);
+        assertBool(std::ranges::equal(appended, sequence), __LINE__,
+                   __FILE__);
+
+        Set<int, CountingLess> chained;
+        CountingLess::comparisons = 0;
+        auto last = chained.end();
+        for (int i = 0; i < n; ++i) {
+            last = chained.insert(last, i);
+        }
+        assertBool(CountingLess::comparisons <= 3 * n, __LINE__, __FILE__);
+        assertBool(std::ranges::equal(chained, sequence), __LINE__, __FILE__);
+        assertEqual(chained.size(), std::size_t(n), __LINE__, __FILE__);
+
+        Set<int> prepended;
+        for (int i = n - 1; i >= 0; --i) {
+            prepended.insert(prepended.begin(), i);
+        }
+        assertBool(std::ranges::equal(prepended, sequence), __LINE__,
+                   __FILE__);
+
+        // The largest key keeps changing under hints at end(): as keys
+        // are erased from either end, cut off, joined back or copied
+        Set<int> window;
+        std::set<int> in_window;
+        int next = 0;
+        for (int round = 0; round < 400; ++round) {
+            for (int i = 0; i < 60; ++i) {
+                window.insert(window.end(), next);
+                in_window.insert(next++);
+            }
+            for (int i = 0; i < 25; ++i) {
+                in_window.erase(*window.begin());
+                window.erase(window.begin());
+            }
+            int largest = *in_window.rbegin();
+            if (round % 5 == 0) {
+                for (int key = largest; key > largest - 30; --key) {
+                    window.erase(key);
+                    in_window.erase(key);
+                }
+            } else if (round % 5 == 1) {
+                window.erase_range(largest - 50, largest + 1);
+                in_window.erase(in_window.lower_bound(largest - 50),
+                                in_window.end());
+            } else if (round % 5 == 2) {
+                Set<int> upper = window.split(largest - 200);
+                window.insert(window.end(), largest + 1000000);
+                window.erase(largest + 1000000);
+                window.join(std::move(upper));
+            } else if (round % 5 == 3) {
+                Set<int> copy = window;
+                window = copy;
+            } else {
+                window = Set<int>(window.begin(), window.end());
+            }
+            assertBool(std::ranges::equal(window, in_window), __LINE__,
+                       __FILE__);
+        }
+
+        // Any hint at all still gives the right set
+        Set<int> set;
+        std::set<int> expected;
+        std::mt19937 rng(25);
+        std::uniform_int_distribution<int> dist(0, 3000);
+        for (int i = 0; i < 20000; ++i) {
+            int key = dist(rng);
+            auto hint = i % 4 == 0 ? set.end() : set.lower_bound(dist(rng));
+            auto it = set.insert(hint, key);
+            expected.insert(key);
+            assertEqual(*it, key, __LINE__, __FILE__);
+            assertEqual(set.size(), expected.size(), __LINE__, __FILE__);
+        }
+        assertBool(std::ranges::equal(set, expected), __LINE__, __FILE__);
+
+        // Which also makes std::inserter work
+        Set<int> copied;
+        std::ranges::copy(expected, std::inserter(copied, copied.end()));
+        assertBool(copied == set, __LINE__, __FILE__);
+    }
+};
+
+static HintedInsertTest hintedInsertTest;
+}  // namespace test
@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct RangeEraseTest {
+    struct CountingLess {
+        static inline std::size_t comparisons = 0;
+
+        auto operator()(int a, int b) const -> bool {
+            ++comparisons;
+            return a < b;
+        }
+    };
+
+    template <typename SetT>
+    static auto check_same(const SetT& set, const std::set<int>& expected)
+        -> void {
+        assertEqual(set.size(), expected.size(), __LINE__, __FILE__);
+        assertBool(std::ranges::equal(set, expected), __LINE__, __FILE__);
+#if defined(SET_ORDER_STATISTICS)
+        std::size_t k = 0;
+        for (int key : expected) {
+            assertEqual(*set.nth(k++), key, __LINE__, __FILE__);
+        }
+#endif
+    }
+
+    // A tree that's been cut and joined many times is still as high as
+    // an AVL tree can be, which a lookup tells by how far it compares:
+    // about two comparisons a level
+    static auto check_balanced(const Set<int, CountingLess>& set) -> void {
+        double height_bound = 1.45 * std::log2(set.size() + 2);
+        std::size_t most = 0;
+        for (int key : set) {
+            CountingLess::comparisons = 0;
+            assertBool(set.contains(key), __LINE__, __FILE__);
+            most = std::max(most, CountingLess::comparisons);
+        }
+        assertBool(most <= 2 * height_bound + 2, __LINE__, __FILE__);
+    }
+
+    RangeEraseTest() {
+        // Time-ordered IDs: the newest are appended, the oldest expire
+        Set<int, CountingLess> window;
+        int oldest = 0;
+        int next = 0;
+        while (next < 5000) {
+            window.insert(window.end(), next++);
+        }
+        for (int round = 0; round < 300; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                window.insert(window.end(), next++);
+            }
+            int expire = 95 + round % 11;
+            assertEqual(window.erase_range(oldest, oldest + expire),
+                        std::size_t(expire), __LINE__, __FILE__);
+            oldest += expire;
+            assertEqual(*window.begin(), oldest, __LINE__, __FILE__);
+            assertEqual(window.size(), std::size_t(next - oldest), __LINE__,
+                        __FILE__);
+        }
+        check_balanced(window);
+
+        // Random ranges, by key and by iterator, against std::set
+        Set<int> set;
+        std::set<int> expected;
+        std::mt19937 rng(26);
+        std::uniform_int_distribution<int> dist(0, 20000);
+        for (int i = 0; i < 4000; ++i) {
+            int key = dist(rng);
+            set.insert(key);
+            expected.insert(key);
+        }
+        for (int i = 0; i < 300; ++i) {
+            int lo = dist(rng);
+            int hi = lo + dist(rng) % 2000;
+            auto first = expected.lower_bound(lo);
+            auto last = i % 3 == 0 ? expected.end() : expected.lower_bound(hi);
+
+            if (i % 2 == 0 && last != expected.end()) {
+                auto count = std::distance(first, last);
+                assertEqual(set.erase_range(lo, hi), std::size_t(count),
+                            __LINE__, __FILE__);
+                expected.erase(first, last);
+            } else {
+                auto set_last = last == expected.end() ? set.end()
+                                                       : set.lower_bound(hi);
+                auto after = set.erase(set.lower_bound(lo), set_last);
+                expected.erase(first, last);
+                assertBool(last == expected.end() ? after == set.end()
+                                                  : *after == *last,
+                           __LINE__, __FILE__);
+            }
+
+            for (int j = 0; j < 20; ++j) {
+                int key = dist(rng);
+                set.insert(key);
+                expected.insert(key);
+            }
+            check_same(set, expected);
+        }
+        assertEqual(set.erase_range(300, 300), std::size_t(0), __LINE__,
+                    __FILE__);
+        assertEqual(set.erase_range(300, 200), std::size_t(0), __LINE__,
+                    __FILE__);
+
+        // Erasing by iterator hands back the key after, also once leaves
+        // run short and borrow or merge
+        Set<int> many;
+        std::set<int> left_over;
+        for (int i = 0; i < 5000; ++i) {
+            many.insert(i);
+            left_over.insert(i);
+        }
+        for (auto it = many.begin(); it != many.end();) {
+            int key = *it;
+            it = many.erase(it);
+            left_over.erase(key);
+            if (it != many.end()) {
+                assertEqual(*it, key + 1, __LINE__, __FILE__);
+                ++it;
+            }
+        }
+        check_same(many, left_over);
+
+        std::vector<int> odds_shuffled(left_over.begin(), left_over.end());
+        std::ranges::shuffle(odds_shuffled, rng);
+        for (int key : odds_shuffled) {
+            auto after = many.erase(many.find(key));
+            auto expected_after = left_over.erase(left_over.find(key));
+            assertBool(expected_after == left_over.end()
+                           ? after == many.end()
+                           : *after == *expected_after,
+                       __LINE__, __FILE__);
+        }
+        assertBool(many.empty(), __LINE__, __FILE__);
+
+        // Split anywhere and join back, in either order
+        for (int key : {-1, 0, 1, 7000, 10000, 19999, 20000, 30000}) {
+            std::set<int> less(expected.begin(), expected.lower_bound(key));
+            std::set<int> rest(expected.lower_bound(key), expected.end());
+
+            Set<int> left = set;
+            Set<int> right = left.split(key);
+            check_same(left, less);
+            check_same(right, rest);
+
+            if (key % 2 == 0) {
+                left.join(std::move(right));
+                check_same(left, expected);
+                assertBool(right.empty(), __LINE__, __FILE__);
+            } else {
+                right.join(std::move(left));
+                check_same(right, expected);
+                assertBool(left.empty(), __LINE__, __FILE__);
+            }
+        }
+
+#if !defined(SET_ENGINE_BTREE)
+        // The larger side keeps its pool, and iterators into it stay valid
+        Set<int> kept;
+        for (int i = 0; i < 1000; ++i) {
+            kept.insert(i);
+        }
+        auto it = kept.find(100);
+        Set<int> upper = kept.split(900);
+        assertEqual(*it, 100, __LINE__, __FILE__);
+        assertBool(++it == kept.find(101), __LINE__, __FILE__);
+
+        kept.join(std::move(upper));
+        assertEqual(*it, 101, __LINE__, __FILE__);
+        assertEqual(std::distance(it, kept.end()), 899, __LINE__, __FILE__);
+#endif
+
+        // Sets that interleave still join, and both can change after
+        Set<int> evens;
+        Set<int> odds;
+        std::set<int> all;
+        for (int i = 0; i < 1000; ++i) {
+            (i % 2 == 0 ? evens : odds).insert(i);
+            all.insert(i);
+        }
+        evens.join(std::move(odds));
+        check_same(evens, all);
+        odds.insert(5);
+        assertEqual(odds.size(), std::size_t(1), __LINE__, __FILE__);
+
+        Set<int, CountingLess> halves;
+        for (int i = 0; i < 20000; ++i) {
+            halves.insert(halves.end(), i);
+        }
+        for (int i = 0; i < 50; ++i) {
+            auto upper = halves.split(dist(rng));
+            upper.join(std::move(halves));
+            halves = upper;
+        }
+        assertEqual(halves.size(), std::size_t(20000), __LINE__, __FILE__);
+        check_balanced(halves);
+    }
+};
+
+static RangeEraseTest rangeEraseTest;
+}  // namespace test
@@ -0,0 +1,97 @@
+#pragma once
+#include <functional>
+#include <latch>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../../Common/ContainerStats.h"
+#include "../PersistentSet.h"
+#include "../Set.h"
+#include "CustomAsserts.h"
+
+namespace test {
+struct CountingAllocatorTest {
+    // Whatever a set allocates goes into the stats it was given, copies
+    // and all, and is given back by the time the last copy is gone
+    template <typename SetT>
+    static auto check_counted() -> void {
+        using Allocator = container_stats::CountingAllocator<int>;
+        container_stats::Stats stats;
+        std::mt19937 rng(27);
+        std::uniform_int_distribution<int> dist(0, 100000);
+
+        {
+            SetT set(std::less<int>{}, Allocator(stats));
+            for (int i = 0; i < 20000; ++i) {
+                set.insert(dist(rng));
+            }
+            assertBool(stats.allocations > 0, __LINE__, __FILE__);
+            assertBool(&set.get_allocator().counted() == &stats, __LINE__,
+                       __FILE__);
+            assertEqual(std::size_t(stats.live_blocks),
+                        stats.allocations - stats.deallocations, __LINE__,
+                        __FILE__);
+
+            // A PersistentSet copy only allocates once it changes
+            std::size_t allocations = stats.allocations;
+            SetT copy = set;
+            for (int i = 0; i < 20000; ++i) {
+                copy.erase(dist(rng));
+            }
+            assertBool(stats.allocations > allocations, __LINE__, __FILE__);
+            assertBool(stats.peak_live_blocks >= stats.live_blocks, __LINE__,
+                       __FILE__);
+        }
+
+        assertBool(stats.bytes > 0, __LINE__, __FILE__);
+        assertEqual(stats.deallocations, stats.allocations, __LINE__,
+                    __FILE__);
+        assertEqual(stats.live_blocks, 0, __LINE__, __FILE__);
+    }
+
+    // Sets on different threads can share one Stats and miss no count
+    static auto check_shared() -> void {
+        using Allocator = container_stats::CountingAllocator<int>;
+        using SetT = PersistentSet<int, std::less<int>, Allocator>;
+        auto fill = [](container_stats::Stats& stats) {
+            SetT set(std::less<int>{}, Allocator(stats));
+            for (int i = 0; i < 20000; ++i) {
+                set.insert(i * 7 % 20011);
+            }
+        };
+
+        container_stats::Stats alone;
+        fill(alone);
+
+        container_stats::Stats shared;
+        std::latch start(4);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&] {
+                start.arrive_and_wait();
+                fill(shared);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        assertEqual(shared.allocations, 4 * alone.allocations, __LINE__,
+                    __FILE__);
+        assertEqual(shared.deallocations, shared.allocations, __LINE__,
+                    __FILE__);
+        assertEqual(shared.live_blocks, 0, __LINE__, __FILE__);
+        assertBool(shared.peak_live_blocks >= alone.peak_live_blocks,
+                   __LINE__, __FILE__);
+    }
+
+    CountingAllocatorTest() {
+        using Allocator = container_stats::CountingAllocator<int>;
+        check_counted<Set<int, std::less<int>, Allocator>>();
+        check_counted<PersistentSet<int, std::less<int>, Allocator>>();
+        check_shared();
+    }
+};
+
+static CountingAllocatorTest countingAllocatorTest;
+}  // namespace test
@@ -1,6 +1,10 @@
 #pragma once
 #include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "../../Common/ContainerStats.h"
 #include "../Set.h"
 #include "CustomAsserts.h"
 
@@ -21,6 +25,27 @@ struct AssignmentOperatorTest {
         assertEqual(set1.size(), set2.size() + 1, __LINE__, __FILE__);
         assertBool(set1 != set2, __LINE__, __FILE__);
         assertBool(!(set1 == set2), __LINE__, __FILE__);
+
+        // Moving takes the nodes over instead of copying them
+        static_assert(std::is_nothrow_move_constructible_v<Set<int>>);
+        static_assert(std::is_nothrow_move_assignable_v<Set<int>>);
+
+        using Allocator = container_stats::CountingAllocator<int>;
+        container_stats::Stats stats;
+        Set<int, std::less<int>, Allocator> counted(std::less<int>{},
+                                                    Allocator(stats));
+        for (int i = 0; i < 1000; ++i) {
+            counted.insert(i);
+        }
+        std::size_t allocations = stats.allocations;
+
+        Set<int, std::less<int>, Allocator> moved = std::move(counted);
+        assertEqual(moved.size(), 1000u, __LINE__, __FILE__);
+        counted = std::move(moved);
+        assertEqual(counted.size(), 1000u, __LINE__, __FILE__);
+        assertBool(counted.contains(0) && counted.contains(999), __LINE__,
+                   __FILE__);
+        assertEqual(stats.allocations, allocations, __LINE__, __FILE__);
     }
 };
 
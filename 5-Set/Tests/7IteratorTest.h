@@ -14,7 +14,7 @@ struct IteratorTest {
         std::vector<int> values{5, 2, 3, 4, 1, 10, 20};
         std::ranges::sort(values);
 
-        Set::iterator it = set.begin();
+        Set<int>::iterator it = set.begin();
         assertEqual(*it, 1, __LINE__, __FILE__);
         assertBool(it == set.begin(), __LINE__, __FILE__);
         assertBool(!(it != set.begin()), __LINE__, __FILE__);
@@ -13,8 +13,31 @@
 #include "Tests/10UpperAndLowerBoundsTest.h"
 #include "Tests/11EraseIteratorTest.h"
 
-// Disable sanitizers and eneable optimizations for this
-// #include "Tests/12TimeLimitTest.h"
+// Tests/12TimeLimitTest.h needs optimizations and no sanitizers,
+// it's built as set-perf-tests by profiles/release.ini
+
+// The B-tree engine doesn't keep iterators valid across insertions
+#if !defined(SET_ENGINE_BTREE)
+#include "Tests/13NodeReuseTest.h"
+#endif
+#include "Tests/14BulkLoadTest.h"
+#include "Tests/15RangeScanTest.h"
+#include "Tests/16BatchLookupTest.h"
+#include "Tests/17SetAlgebraTest.h"
+
+// Built as set-order-statistics-tests
+#if defined(SET_ORDER_STATISTICS)
+#include "Tests/18OrderStatisticsTest.h"
+#endif
+#include "Tests/19GenericKeysTest.h"
+#include "Tests/20ConcurrentSetTest.h"
+#include "Tests/21PersistentSetTest.h"
+#include "Tests/22FrozenSetTest.h"
+#include "Tests/23FreezeTest.h"
+#include "Tests/24KeySearchTest.h"
+#include "Tests/25HintedInsertTest.h"
+#include "Tests/26RangeEraseTest.h"
+#include "Tests/27CountingAllocatorTest.h"
 
 #include <iostream>
 
@@ -0,0 +1,10 @@
+#include "Set.h"
+
+// Wall-clock limits, only built in the release profile
+#include "Tests/12TimeLimitTest.h"
+
+#include <iostream>
+
+auto main() -> int {
+    std::cout << "All tests have passed :3\n";
+}
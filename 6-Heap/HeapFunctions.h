@@ -2,6 +2,8 @@
 
 #include <iterator>
 
+#include "../Common/ContainerStats.h"
+
 template <std::random_access_iterator It, typename Compare>
 struct HeapView {
     using diff_t = std::iter_difference_t<It>;
@@ -28,6 +30,7 @@ struct HeapView {
 
         if (largest != node) {
             std::swap(first[largest], first[node]);
+            container_stats::count_sift_step();
             heapify(largest);
         }
     }
@@ -58,6 +61,7 @@ struct HeapView {
             }
 
             std::swap(first[parent], first[node]);
+            container_stats::count_sift_step();
             node = parent;
         }
     }
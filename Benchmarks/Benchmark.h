@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../Common/ContainerStats.h"
+
+namespace bench {
+
+// Updated by the replacement `operator new` in main.cpp,
+// from whichever thread a benchmark happens to allocate on
+inline std::atomic<std::size_t> allocation_count = 0;
+inline std::atomic<std::size_t> allocated_bytes = 0;
+
+// Bumped by the counting comparators used by the benchmarks themselves
+inline std::size_t comparison_count = 0;
+
+inline const std::vector<std::size_t> default_sizes{1 << 10, 1 << 14, 1 << 17};
+
+struct State {
+    std::size_t size;
+
+    // Accumulated over every `measure` call of one run
+    double nanoseconds = 0;
+    std::size_t ops = 0;
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t comparisons = 0;
+    // From container_stats, see CONTAINER_STATS in meson.build
+    std::size_t rotations = 0;
+    std::size_t sift_steps = 0;
+    std::size_t peak_live_blocks = 0;  // the most at once, not per op
+
+    explicit State(std::size_t size) : size(size) {}
+
+    // Only the work inside `f` is timed and counted,
+    // so setup and teardown can live in the benchmark body around it.
+    // `ops` is the number of operations `f` performs.
+    template <typename F>
+    auto measure(std::size_t ops, F&& f) -> void {
+        std::size_t allocations_before = allocation_count;
+        std::size_t bytes_before = allocated_bytes;
+        std::size_t comparisons_before = comparison_count;
+        container_stats::Stats stats_before = container_stats::current();
+        container_stats::reset_peak();
+
+        auto start = std::chrono::steady_clock::now();
+        std::forward<F>(f)();
+        auto end = std::chrono::steady_clock::now();
+
+        nanoseconds += std::chrono::duration<double, std::nano>(end - start)
+                           .count();
+        allocations += allocation_count - allocations_before;
+        bytes += allocated_bytes - bytes_before;
+        comparisons += comparison_count - comparisons_before;
+        this->ops += ops;
+
+        const container_stats::Stats& stats = container_stats::current();
+        rotations += stats.rotations - stats_before.rotations;
+        sift_steps += stats.sift_steps - stats_before.sift_steps;
+        std::ptrdiff_t peak = stats.peak_live_blocks - stats_before.live_blocks;
+        peak_live_blocks =
+            std::max(peak_live_blocks, static_cast<std::size_t>(peak));
+    }
+};
+
+struct Benchmark {
+    std::string name;
+    std::vector<std::size_t> sizes;
+    std::function<void(State&)> body;
+};
+
+inline auto registry() -> std::vector<Benchmark>& {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registration {
+    Registration(std::string name,
+                 std::function<void(State&)> body,
+                 std::vector<std::size_t> sizes = default_sizes) {
+        registry().push_back({std::move(name), std::move(sizes),
+                              std::move(body)});
+    }
+};
+
+// Same seed every run, so every run measures the same inputs
+inline auto shuffled_keys(std::size_t n) -> std::vector<int> {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::mt19937 rng(42);
+    std::ranges::shuffle(keys, rng);
+    return keys;
+}
+
+// Keeps the optimizer from throwing away results nobody reads
+template <typename T>
+auto do_not_optimize(const T& value) -> void {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline constexpr std::size_t warmup_runs = 1;
+inline constexpr std::size_t measured_runs = 5;
+
+// The median run of one (benchmark, size) pair, counters per operation
+struct Result {
+    std::string name;
+    std::size_t size;
+    double nanoseconds;
+    double allocations;
+    double bytes;
+    double comparisons;
+    double rotations;
+    double sift_steps;
+    std::size_t peak_live_blocks;
+};
+
+// Runs every benchmark whose name contains `filter`.
+// Each (benchmark, size) pair is warmed up and then measured several times;
+// the reported time is the median run, the counters are per operation.
+inline auto run(std::string_view filter) -> std::vector<Result> {
+    std::cout << std::left << std::setw(36) << "benchmark" << std::right
+              << std::setw(10) << "size" << std::setw(14) << "ns/op"
+              << std::setw(14) << "allocs/op" << std::setw(14) << "bytes/op"
+              << std::setw(14) << "cmp/op" << '\n';
+
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : registry()) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        for (std::size_t size : benchmark.sizes) {
+            for (std::size_t i = 0; i < warmup_runs; ++i) {
+                State state(size);
+                benchmark.body(state);
+            }
+
+            std::vector<State> runs;
+            for (std::size_t i = 0; i < measured_runs; ++i) {
+                runs.emplace_back(size);
+                benchmark.body(runs.back());
+            }
+
+            std::ranges::sort(runs, {}, [](const State& state) {
+                return state.nanoseconds / std::max<std::size_t>(state.ops, 1);
+            });
+            const State& median = runs[runs.size() / 2];
+            double ops = std::max<std::size_t>(median.ops, 1);
+
+            const Result& result = results.emplace_back(
+                benchmark.name, size, median.nanoseconds / ops,
+                median.allocations / ops, median.bytes / ops,
+                median.comparisons / ops, median.rotations / ops,
+                median.sift_steps / ops, median.peak_live_blocks);
+
+            std::cout << std::left << std::setw(36) << result.name
+                      << std::right << std::setw(10) << size << std::fixed
+                      << std::setprecision(2) << std::setw(14)
+                      << result.nanoseconds << std::setw(14)
+                      << result.allocations << std::setw(14) << result.bytes
+                      << std::setw(14) << result.comparisons << '\n';
+        }
+    }
+    return results;
+}
+
+// One object per result, in the order they ran, for tools that track
+// the numbers across commits
+inline auto write_json(std::ostream& os, const std::vector<Result>& results)
+    -> void {
+    auto quoted = [](std::string_view text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out + '"';
+    };
+
+    os << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        os << "  {\"name\": " << quoted(result.name)
+           << ", \"size\": " << result.size << std::fixed
+           << std::setprecision(3)
+           << ", \"ns_per_op\": " << result.nanoseconds
+           << ", \"allocs_per_op\": " << result.allocations
+           << ", \"bytes_per_op\": " << result.bytes
+           << ", \"comparisons_per_op\": " << result.comparisons
+           << ", \"rotations_per_op\": " << result.rotations
+           << ", \"sift_steps_per_op\": " << result.sift_steps
+           << ", \"peak_live_blocks\": " << result.peak_live_blocks << "}"
+           << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "]\n";
+}
+
+}  // namespace bench
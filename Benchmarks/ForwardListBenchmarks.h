@@ -0,0 +1,62 @@
+#pragma once
+#include "../3-ForwardList/ForwardList.h"
+#include "../Common/NodeAllocators.h"
+#include "Benchmark.h"
+
+namespace bench {
+// Every list allocates through a CountingAllocator into this thread's
+// stats, so the results show how many nodes it held at once
+template <typename T>
+using TrackedForwardList =
+    ForwardList<T, container_stats::CountingAllocator<T>>;
+
+static Registration forwardListPushFront(
+    "ForwardList::push_front",
+    [](State& state) {
+        TrackedForwardList<int> list;
+
+        state.measure(state.size, [&] {
+            for (std::size_t i = 0; i < state.size; ++i) {
+                list.push_front(static_cast<int>(i));
+            }
+        });
+
+        do_not_optimize(list.front());
+    });
+
+// Builds a list and drops it, the whole life of a scratch list,
+// with nodes from `alloc`
+template <typename A>
+auto forward_list_build_drop(State& state, const A& alloc) -> void {
+    state.measure(state.size, [&] {
+        ForwardList<int, A> list(alloc);
+        for (std::size_t i = 0; i < state.size; ++i) {
+            list.push_front(static_cast<int>(i));
+        }
+        do_not_optimize(list.front());
+    });
+}
+
+static Registration forwardListBuildDrop(
+    "ForwardList::push_front + destroy",
+    [](State& state) {
+        forward_list_build_drop(state,
+                                container_stats::CountingAllocator<int>());
+    });
+static Registration forwardListBuildDropPool(
+    "ForwardList::push_front + destroy (NodePool)",
+    [](State& state) {
+        NodePool pool;
+        using Allocator =
+            container_stats::CountingAllocator<int, PoolAllocator<int>>;
+        forward_list_build_drop(state, Allocator(PoolAllocator<int>(pool)));
+    });
+static Registration forwardListBuildDropArena(
+    "ForwardList::push_front + destroy (Arena)",
+    [](State& state) {
+        Arena arena;
+        using Allocator =
+            container_stats::CountingAllocator<int, ArenaAllocator<int>>;
+        forward_list_build_drop(state, Allocator(ArenaAllocator<int>(arena)));
+    });
+}  // namespace bench
@@ -0,0 +1,46 @@
+#pragma once
+#include "../6-Heap/HeapFunctions.h"
+#include "Benchmark.h"
+
+namespace bench {
+inline auto counting_less(int a, int b) -> bool {
+    ++comparison_count;
+    return a < b;
+}
+
+static Registration makeHeapBenchmark("makeHeap", [](State& state) {
+    auto keys = shuffled_keys(state.size);
+
+    state.measure(keys.size(), [&] {
+        makeHeap(keys.begin(), keys.end(), counting_less);
+    });
+
+    do_not_optimize(keys.front());
+});
+
+static Registration popHeapBenchmark("popHeap", [](State& state) {
+    auto keys = shuffled_keys(state.size);
+    makeHeap(keys.begin(), keys.end(), counting_less);
+
+    state.measure(keys.size(), [&] {
+        for (auto last = keys.end(); last != keys.begin(); --last) {
+            popHeap(keys.begin(), last, counting_less);
+        }
+    });
+
+    do_not_optimize(keys.front());
+});
+
+static Registration pushHeapBenchmark("pushHeap", [](State& state) {
+    auto keys = shuffled_keys(state.size);
+
+    state.measure(keys.size(), [&] {
+        for (auto last = keys.begin(); last != keys.end();) {
+            ++last;
+            pushHeap(keys.begin(), last, counting_less);
+        }
+    });
+
+    do_not_optimize(keys.front());
+});
+}  // namespace bench
@@ -0,0 +1,193 @@
+#pragma once
+#include <compare>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../4-List/List.h"
+#include "../Common/NodeAllocators.h"
+#include "Benchmark.h"
+
+namespace bench {
+// Every list allocates through a CountingAllocator into this thread's
+// stats, so the results show how many nodes it held at once
+template <typename T>
+using TrackedList = List<T, container_stats::CountingAllocator<T>>;
+
+// int that counts every comparison made on it
+struct CountedInt {
+    int value;
+
+    auto operator<=>(const CountedInt& other) const -> std::strong_ordering {
+        ++comparison_count;
+        return value <=> other.value;
+    }
+    auto operator==(const CountedInt& other) const -> bool {
+        ++comparison_count;
+        return value == other.value;
+    }
+};
+
+static Registration listSortRandom("List::sort (random)", [](State& state) {
+    auto keys = shuffled_keys(state.size);
+    TrackedList<CountedInt> list;
+    for (int key : keys) {
+        list.push_back({key});
+    }
+
+    state.measure(state.size, [&] { list.sort(); });
+
+    do_not_optimize(list.front());
+});
+
+// Inputs a first-element-pivot quick sort took quadratic time on
+static Registration listSortSorted("List::sort (sorted)", [](State& state) {
+    TrackedList<CountedInt> list;
+    for (std::size_t i = 0; i < state.size; ++i) {
+        list.push_back({static_cast<int>(i)});
+    }
+
+    state.measure(state.size, [&] { list.sort(); });
+
+    do_not_optimize(list.front());
+});
+
+static Registration listSortReversed("List::sort (reversed)", [](State& state) {
+    TrackedList<CountedInt> list;
+    for (std::size_t i = 0; i < state.size; ++i) {
+        list.push_front({static_cast<int>(i)});
+    }
+
+    state.measure(state.size, [&] { list.sort(); });
+
+    do_not_optimize(list.front());
+});
+
+static Registration listSize(
+    "List::size",
+    [](State& state) {
+        TrackedList<int> list(state.size, 0);
+        constexpr std::size_t calls = 100;
+
+        state.measure(calls, [&] {
+            for (std::size_t i = 0; i < calls; ++i) {
+                do_not_optimize(list.size());
+            }
+        });
+    },
+    {1 << 10, 1 << 14, 1 << 20});
+
+// Fills a list with strings too long to fit inline, copied or moved in
+template <bool by_move>
+auto list_push_strings(State& state) -> void {
+    std::vector<std::string> strings(state.size, std::string(64, 'x'));
+    TrackedList<std::string> list;
+
+    state.measure(state.size, [&] {
+        for (std::string& string : strings) {
+            if constexpr (by_move) {
+                list.push_back(std::move(string));
+            } else {
+                list.push_back(string);
+            }
+        }
+    });
+
+    do_not_optimize(list.back());
+}
+
+static Registration listPushStringsCopy("List::push_back (string, copy)",
+                                        list_push_strings<false>);
+static Registration listPushStringsMove("List::push_back (string, move)",
+                                        list_push_strings<true>);
+
+// Merges two sorted runs of interleaved keys, copying one into the other
+// or relinking its nodes
+template <bool by_move>
+auto list_merge(State& state) -> void {
+    TrackedList<int> evens;
+    TrackedList<int> odds;
+    for (std::size_t i = 0; i < state.size; ++i) {
+        (i % 2 == 0 ? evens : odds).push_back(static_cast<int>(i));
+    }
+
+    state.measure(state.size, [&] {
+        if constexpr (by_move) {
+            evens.merge(std::move(odds));
+        } else {
+            evens.merge(odds);
+        }
+    });
+
+    do_not_optimize(evens.back());
+}
+
+static Registration listMergeCopy("List::merge (copy)", list_merge<false>);
+static Registration listMergeMove("List::merge (move)", list_merge<true>);
+
+// Moves touched entries to the front, as an LRU cache does: by relinking,
+// or by copying into a new node and freeing the old one
+template <bool by_splice>
+auto list_lru_touch(State& state) -> void {
+    TrackedList<int> list;
+    std::vector<TrackedList<int>::iterator> where(state.size);
+    for (std::size_t i = 0; i < state.size; ++i) {
+        list.push_front(static_cast<int>(i));
+        where[i] = list.begin();
+    }
+    auto keys = shuffled_keys(state.size);
+
+    state.measure(state.size, [&] {
+        for (int key : keys) {
+            if constexpr (by_splice) {
+                list.splice(list.begin(), list, where[key]);
+            } else {
+                list.push_front(*where[key]);
+                list.erase(where[key]);
+                where[key] = list.begin();
+            }
+        }
+    });
+
+    do_not_optimize(list.front());
+}
+
+static Registration listLruSplice("List::splice (LRU touch)",
+                                  list_lru_touch<true>);
+static Registration listLruCopy("List::erase + push_front (LRU touch)",
+                                list_lru_touch<false>);
+
+// Builds a list and drops it, the whole life of a scratch list,
+// with nodes from `alloc`
+template <typename A>
+auto list_build_drop(State& state, const A& alloc) -> void {
+    state.measure(state.size, [&] {
+        List<int, A> list(alloc);
+        for (std::size_t i = 0; i < state.size; ++i) {
+            list.push_back(static_cast<int>(i));
+        }
+        do_not_optimize(list.back());
+    });
+}
+
+static Registration listBuildDrop(
+    "List::push_back + destroy",
+    [](State& state) {
+        list_build_drop(state, container_stats::CountingAllocator<int>());
+    });
+static Registration listBuildDropPool(
+    "List::push_back + destroy (NodePool)",
+    [](State& state) {
+        NodePool pool;
+        using Allocator =
+            container_stats::CountingAllocator<int, PoolAllocator<int>>;
+        list_build_drop(state, Allocator(PoolAllocator<int>(pool)));
+    });
+static Registration listBuildDropArena(
+    "List::push_back + destroy (Arena)",
+    [](State& state) {
+        Arena arena;
+        using Allocator =
+            container_stats::CountingAllocator<int, ArenaAllocator<int>>;
+        list_build_drop(state, Allocator(ArenaAllocator<int>(arena)));
+    });
+}  // namespace bench
@@ -0,0 +1,618 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include "../5-Set/BTreeSet.h"
+#include "../5-Set/ConcurrentSet.h"
+#include "../5-Set/FrozenSetFile.h"
+#include "../5-Set/KeySearch.h"
+#include "../5-Set/PersistentSet.h"
+#include "../5-Set/Set.h"
+#include "Benchmark.h"
+
+namespace bench {
+// Counts every comparison, for the rows that report comparisons per
+// operation. The plain rows keep std::less<int> and its fast key search.
+struct CountingLess {
+    auto operator()(int a, int b) const -> bool {
+        ++comparison_count;
+        return a < b;
+    }
+};
+
+// Every node set allocates through a CountingAllocator into this thread's
+// stats, so the results show how many blocks it held at once
+template <typename Compare = std::less<int>>
+using TrackedSet =
+    Set<int, Compare, container_stats::CountingAllocator<int>>;
+template <typename Compare = std::less<int>>
+using TrackedBTreeSet =
+    BTreeSet<int, Compare, container_stats::CountingAllocator<int>>;
+
+template <typename SetT>
+auto set_insert_random(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+
+    state.measure(keys.size(), [&] {
+        for (int key : keys) {
+            set.insert(key);
+        }
+    });
+
+    do_not_optimize(set.size());
+}
+
+template <typename SetT>
+auto set_insert_sequential(State& state) -> void {
+    SetT set;
+
+    state.measure(state.size, [&] {
+        for (std::size_t i = 0; i < state.size; ++i) {
+            set.insert(static_cast<int>(i));
+        }
+    });
+
+    do_not_optimize(set.size());
+}
+
+// Same keys with end() as the hint, which is always right for them
+template <typename SetT>
+auto set_insert_sequential_hinted(State& state) -> void {
+    SetT set;
+
+    state.measure(state.size, [&] {
+        for (std::size_t i = 0; i < state.size; ++i) {
+            set.insert(set.end(), static_cast<int>(i));
+        }
+    });
+
+    do_not_optimize(set.size());
+}
+
+template <typename SetT>
+auto set_bulk_load(State& state) -> void {
+    std::vector<int> keys(state.size);
+    std::iota(keys.begin(), keys.end(), 0);
+
+    state.measure(keys.size(), [&] {
+        SetT set(keys.begin(), keys.end());
+        do_not_optimize(set.size());
+    });
+}
+
+template <typename SetT>
+auto set_find(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+    for (int key : keys) {
+        set.insert(key);
+    }
+    std::ranges::reverse(keys);
+
+    state.measure(keys.size(), [&] {
+        for (int key : keys) {
+            do_not_optimize(set.find(key));
+        }
+    });
+}
+
+template <typename SetT>
+auto set_contains(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+    for (int key : keys) {
+        set.insert(key);
+    }
+    std::ranges::reverse(keys);
+    auto found = std::make_unique<bool[]>(keys.size());
+
+    state.measure(keys.size(), [&] {
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            found[i] = set.contains(keys[i]);
+        }
+    });
+
+    do_not_optimize(found[0]);
+}
+
+// Same lookups as set_contains, in one batch
+template <typename SetT>
+auto set_contains_many(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+    for (int key : keys) {
+        set.insert(key);
+    }
+    std::ranges::reverse(keys);
+    auto found = std::make_unique<bool[]>(keys.size());
+
+    state.measure(keys.size(), [&] {
+        set.contains_many(keys, {found.get(), keys.size()});
+    });
+
+    do_not_optimize(found[0]);
+}
+
+template <typename SetT>
+auto set_iterate(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+    for (int key : keys) {
+        set.insert(key);
+    }
+
+    state.measure(keys.size(), [&] {
+        long sum = 0;
+        for (int key : set) {
+            sum += key;
+        }
+        do_not_optimize(sum);
+    });
+}
+
+template <typename SetT>
+auto set_scan(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+    for (int key : keys) {
+        set.insert(key);
+    }
+    std::vector<int> out(256);
+
+    state.measure(keys.size(), [&] {
+        int from = 0;
+        while (std::size_t n = set.scan(from, static_cast<int>(keys.size()),
+                                        out)) {
+            from = out[n - 1] + 1;
+        }
+        do_not_optimize(out.data());
+    });
+}
+
+// Two sets of `size` random keys each, half of them shared
+template <typename SetT>
+auto overlapping_sets(std::size_t size) -> std::pair<SetT, SetT> {
+    auto keys = shuffled_keys(size + size / 2);
+    return {SetT(keys.begin(), keys.begin() + size),
+            SetT(keys.end() - size, keys.end())};
+}
+
+// What merging two sets took before set_union
+template <typename SetT>
+auto set_union_by_insert(State& state) -> void {
+    auto [a, b] = overlapping_sets<SetT>(state.size);
+
+    state.measure(a.size() + b.size(), [&] {
+        SetT result = a;
+        for (int key : b) {
+            result.insert(key);
+        }
+        do_not_optimize(result.size());
+    });
+}
+
+template <typename SetT>
+auto set_union_merge(State& state) -> void {
+    auto [a, b] = overlapping_sets<SetT>(state.size);
+
+    state.measure(a.size() + b.size(), [&] {
+        SetT result = set_union(a, b);
+        do_not_optimize(result.size());
+    });
+}
+
+// A large set and a handful of new keys from all over its range
+template <typename SetT>
+auto set_union_skewed(State& state) -> void {
+    auto keys = shuffled_keys(state.size + 16);
+    SetT large(keys.begin(), keys.end() - 16);
+    SetT small(keys.end() - 16, keys.end());
+
+    state.measure(small.size(), [&] {
+        SetT result = set_union(large, small);
+        do_not_optimize(result.size());
+    });
+}
+
+template <typename SetT>
+auto set_intersection_merge(State& state) -> void {
+    auto [a, b] = overlapping_sets<SetT>(state.size);
+
+    state.measure(a.size() + b.size(), [&] {
+        SetT result = set_intersection(a, b);
+        do_not_optimize(result.size());
+    });
+}
+
+template <typename SetT>
+auto set_erase(State& state) -> void {
+    auto keys = shuffled_keys(state.size);
+    SetT set;
+    for (int key : keys) {
+        set.insert(key);
+    }
+    std::ranges::reverse(keys);
+
+    state.measure(keys.size(), [&] {
+        for (int key : keys) {
+            set.erase(key);
+        }
+    });
+
+    do_not_optimize(set.size());
+}
+
+// A sliding window of time-ordered IDs: every round appends a batch of
+// new ones and expires the oldest batch, either as one range or key by key.
+// One op is one expired ID.
+template <typename SetT, bool by_range>
+auto set_expire(State& state) -> void {
+    constexpr int batch = 256;
+    constexpr int rounds = 64;
+    SetT set;
+    int oldest = 0;
+    int next = 0;
+    while (next < static_cast<int>(state.size)) {
+        set.insert(set.end(), next++);
+    }
+
+    state.measure(std::size_t(batch) * rounds, [&] {
+        for (int round = 0; round < rounds; ++round) {
+            for (int i = 0; i < batch; ++i) {
+                set.insert(set.end(), next++);
+            }
+            if constexpr (by_range) {
+                set.erase_range(oldest, oldest + batch);
+            } else {
+                for (int key = oldest; key < oldest + batch; ++key) {
+                    set.erase(key);
+                }
+            }
+            oldest += batch;
+        }
+    });
+
+    do_not_optimize(set.size());
+}
+
+// Reads from a snapshot while the set itself keeps changing,
+// one op is one snapshot plus one insertion into the original
+template <typename SetT>
+auto set_snapshot(State& state) -> void {
+    SetT set;
+    for (int key : shuffled_keys(state.size)) {
+        set.insert(key);
+    }
+    constexpr std::size_t snapshots = 64;
+    int next = static_cast<int>(state.size);
+
+    state.measure(snapshots, [&] {
+        for (std::size_t i = 0; i < snapshots; ++i) {
+            SetT snapshot = set;
+            set.insert(next++);
+            do_not_optimize(snapshot.size());
+        }
+    });
+}
+
+// A saved set of `size` keys for the startup benchmarks below to read
+inline auto saved_set_path(std::size_t size) -> std::filesystem::path {
+    auto path = std::filesystem::temp_directory_path() / "ds-bench-set";
+    auto keys = shuffled_keys(size);
+    Set<int> set(keys.begin(), keys.end());
+    std::ofstream out(path, std::ios::binary);
+    FrozenSet<int>::save(set, out);
+    return path;
+}
+
+inline constexpr std::size_t startups = 16;
+
+// One op is one startup: the set is ready and has answered a lookup
+inline auto frozen_set_open(State& state) -> void {
+    auto path = saved_set_path(state.size);
+
+    state.measure(startups, [&] {
+        for (std::size_t i = 0; i < startups; ++i) {
+            auto set = FrozenSet<int>::open(path.string());
+            do_not_optimize(set.contains(0));
+        }
+    });
+
+    std::filesystem::remove(path);
+}
+
+// The same startup by reading every key and building the tree again
+inline auto set_reload(State& state) -> void {
+    auto path = saved_set_path(state.size);
+
+    state.measure(startups, [&] {
+        for (std::size_t i = 0; i < startups; ++i) {
+            std::ifstream in(path, std::ios::binary);
+            auto keys = FrozenSet<int>::load(in);
+            TrackedSet<> set(keys.begin(), keys.end());
+            do_not_optimize(set.contains(0));
+        }
+    });
+
+    std::filesystem::remove(path);
+}
+
+// Rank of a random int in one sorted block the size of a B-tree node,
+// with each of the key_search versions
+template <auto count_less>
+auto block_search(State& state) -> void {
+    std::vector<int> block(state.size);
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        block[i] = static_cast<int>(4 * i);
+    }
+    std::vector<int> lookups(1 << 12);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 4 * block.back() / 3 + 1);
+    for (int& key : lookups) {
+        key = dist(rng);
+    }
+    int n = static_cast<int>(block.size());
+
+    state.measure(lookups.size(), [&] {
+        for (int key : lookups) {
+            do_not_optimize(count_less(block.data(), n, key));
+        }
+    });
+}
+
+inline const std::vector<std::size_t> block_sizes{16, 32, 64};
+
+// Up to what the pointer tree and its frozen copy still fit in a few GB
+inline const std::vector<std::size_t> large_sizes{1 << 10, 1 << 14, 1 << 17,
+                                                  1 << 20, 1 << 23};
+
+// Random lower_bound lookups in 0, 2, 4, ... built into whatever `build`
+// makes out of a Set. Every lookup has a bound, half of them exact.
+template <typename Build>
+auto lower_bound_large(State& state, Build build) -> void {
+    std::vector<int> keys(state.size);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = static_cast<int>(2 * i);
+    }
+    Set<int> set(keys.begin(), keys.end());
+    const auto& searched = build(set);
+
+    std::vector<int> lookups(1 << 16);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, keys.back());
+    for (int& key : lookups) {
+        key = dist(rng);
+    }
+
+    state.measure(lookups.size(), [&] {
+        for (int key : lookups) {
+            do_not_optimize(*searched.lower_bound(key));
+        }
+    });
+}
+
+inline auto set_lower_bound_large(State& state) -> void {
+    lower_bound_large(state, [](const Set<int>& set) -> const Set<int>& {
+        return set;
+    });
+}
+
+inline auto btree_set_lower_bound_large(State& state) -> void {
+    lower_bound_large(state, [](const Set<int>& set) {
+        return BTreeSet<int>(set.begin(), set.end());
+    });
+}
+
+inline auto sorted_frozen_set_lower_bound(State& state) -> void {
+    lower_bound_large(state,
+                      [](const Set<int>& set) { return FrozenSet<int>(set); });
+}
+
+inline auto frozen_set_lower_bound(State& state) -> void {
+    lower_bound_large(state, [](const Set<int>& set) { return set.freeze(); });
+}
+
+inline constexpr std::size_t concurrent_readers = 4;
+
+// Every reader looks up all keys while one writer keeps inserting and
+// erasing keys past them; ops are the lookups of all readers together
+template <typename Lookup, typename Update>
+auto lookups_under_writer(State& state, Lookup lookup, Update update)
+    -> void {
+    auto keys = shuffled_keys(state.size);
+    int churn = static_cast<int>(state.size);
+
+    state.measure(concurrent_readers * keys.size(), [&] {
+        std::atomic<bool> writing = true;
+        std::thread writer([&] {
+            for (int i = 0; writing.load(std::memory_order_relaxed); ++i) {
+                update(churn + i % churn, i / churn % 2 == 0);
+            }
+        });
+
+        std::vector<std::thread> readers;
+        for (std::size_t r = 0; r < concurrent_readers; ++r) {
+            readers.emplace_back([&] {
+                for (int key : keys) {
+                    do_not_optimize(lookup(key));
+                }
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        writing = false;
+        writer.join();
+    });
+}
+
+inline auto concurrent_set_contains(State& state) -> void {
+    ConcurrentSet<int> set;
+    for (int key : shuffled_keys(state.size)) {
+        set.insert(key);
+    }
+
+    lookups_under_writer(
+        state, [&](int key) { return set.contains(key); },
+        [&](int key, bool insert) {
+            if (insert) {
+                set.insert(key);
+            } else {
+                set.erase(key);
+            }
+        });
+}
+
+// The baseline ConcurrentSet has to beat: one lock around the plain Set
+inline auto shared_mutex_set_contains(State& state) -> void {
+    Set<int> set;
+    std::shared_mutex mutex;
+    for (int key : shuffled_keys(state.size)) {
+        set.insert(key);
+    }
+
+    lookups_under_writer(
+        state,
+        [&](int key) {
+            std::shared_lock lock(mutex);
+            return set.contains(key);
+        },
+        [&](int key, bool insert) {
+            std::unique_lock lock(mutex);
+            if (insert) {
+                set.insert(key);
+            } else {
+                set.erase(key);
+            }
+        });
+}
+
+static Registration setInsertRandom("Set::insert (random)",
+                                    set_insert_random<TrackedSet<>>);
+static Registration setInsertSequential("Set::insert (sequential)",
+                                        set_insert_sequential<TrackedSet<>>);
+static Registration setInsertSequentialHinted(
+    "Set::insert (sequential, hinted)",
+    set_insert_sequential_hinted<TrackedSet<>>);
+static Registration setBulkLoad("Set::Set(sorted range)",
+                                set_bulk_load<TrackedSet<>>);
+static Registration setFind("Set::find", set_find<TrackedSet<>>);
+static Registration setInsertRandomCounted(
+    "Set::insert (random, counted)",
+    set_insert_random<TrackedSet<CountingLess>>);
+static Registration setFindCounted("Set::find (counted)",
+                                   set_find<TrackedSet<CountingLess>>);
+static Registration setEraseCounted("Set::erase (counted)",
+                                    set_erase<TrackedSet<CountingLess>>);
+static Registration setContains("Set::contains", set_contains<TrackedSet<>>);
+static Registration setContainsMany("Set::contains_many",
+                                    set_contains_many<TrackedSet<>>);
+static Registration setIterate("Set::iterator (full scan)",
+                               set_iterate<TrackedSet<>>);
+static Registration setScan("Set::scan", set_scan<TrackedSet<>>);
+static Registration setErase("Set::erase", set_erase<TrackedSet<>>);
+static Registration setExpire("Set::erase_range (expiry)",
+                             set_expire<TrackedSet<>, true>);
+static Registration setExpireByKey("Set::erase (expiry, key by key)",
+                                   set_expire<TrackedSet<>, false>);
+static Registration setUnionByInsert("Set::insert (union)",
+                                     set_union_by_insert<TrackedSet<>>);
+static Registration setUnion("set_union(Set)", set_union_merge<TrackedSet<>>);
+static Registration setUnionSkewed("set_union(Set, 16 keys)",
+                                   set_union_skewed<TrackedSet<>>);
+static Registration setIntersection("set_intersection(Set)",
+                                    set_intersection_merge<TrackedSet<>>);
+
+static Registration btreeSetInsertRandom("BTreeSet::insert (random)",
+                                         set_insert_random<TrackedBTreeSet<>>);
+static Registration btreeSetInsertSequential(
+    "BTreeSet::insert (sequential)",
+    set_insert_sequential<TrackedBTreeSet<>>);
+static Registration btreeSetInsertSequentialHinted(
+    "BTreeSet::insert (sequential, hinted)",
+    set_insert_sequential_hinted<TrackedBTreeSet<>>);
+static Registration btreeSetBulkLoad("BTreeSet::BTreeSet(sorted range)",
+                                     set_bulk_load<TrackedBTreeSet<>>);
+static Registration btreeSetFind("BTreeSet::find", set_find<TrackedBTreeSet<>>);
+static Registration btreeSetInsertRandomCounted(
+    "BTreeSet::insert (random, counted)",
+    set_insert_random<TrackedBTreeSet<CountingLess>>);
+static Registration btreeSetFindCounted(
+    "BTreeSet::find (counted)", set_find<TrackedBTreeSet<CountingLess>>);
+static Registration btreeSetEraseCounted(
+    "BTreeSet::erase (counted)",
+    set_erase<TrackedBTreeSet<CountingLess>>);
+static Registration btreeSetContains("BTreeSet::contains",
+                                     set_contains<TrackedBTreeSet<>>);
+static Registration btreeSetContainsMany("BTreeSet::contains_many",
+                                         set_contains_many<TrackedBTreeSet<>>);
+static Registration btreeSetIterate("BTreeSet::iterator (full scan)",
+                                    set_iterate<TrackedBTreeSet<>>);
+static Registration btreeSetScan("BTreeSet::scan", set_scan<TrackedBTreeSet<>>);
+static Registration btreeSetErase("BTreeSet::erase",
+                                  set_erase<TrackedBTreeSet<>>);
+static Registration btreeSetExpire("BTreeSet::erase_range (expiry)",
+                                  set_expire<TrackedBTreeSet<>, true>);
+static Registration btreeSetExpireByKey(
+    "BTreeSet::erase (expiry, key by key)",
+    set_expire<TrackedBTreeSet<>, false>);
+static Registration btreeSetUnionByInsert(
+    "BTreeSet::insert (union)", set_union_by_insert<TrackedBTreeSet<>>);
+static Registration btreeSetUnion("set_union(BTreeSet)",
+                                  set_union_merge<TrackedBTreeSet<>>);
+static Registration btreeSetUnionSkewed(
+    "set_union(BTreeSet, 16 keys)", set_union_skewed<TrackedBTreeSet<>>);
+static Registration btreeSetIntersection(
+    "set_intersection(BTreeSet)", set_intersection_merge<TrackedBTreeSet<>>);
+
+static Registration setSnapshot("Set::Set(const Set&) + insert",
+                                set_snapshot<TrackedSet<>>);
+// Counted, so the results show how many nodes the snapshots keep alive
+static Registration persistentSetSnapshot(
+    "PersistentSet copy + insert",
+    set_snapshot<PersistentSet<int, std::less<int>,
+                               container_stats::CountingAllocator<int>>>);
+
+static Registration frozenSetOpen("FrozenSet::open (startup)",
+                                  frozen_set_open);
+static Registration setReload("Set reload (startup)", set_reload);
+
+static Registration blockSearchScalar(
+    "count_less (scalar)",
+    block_search<key_search::detail::count_less_scalar>, block_sizes);
+#if defined(__SSE2__)
+static Registration blockSearchSse2(
+    "count_less (SSE2)",
+    block_search<key_search::detail::count_less_sse2>, block_sizes);
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+static Registration blockSearchAvx2(
+    "count_less (AVX2)",
+    [](State& state) {
+        if (key_search::detail::has_avx2) {
+            block_search<key_search::detail::count_less_avx2>(state);
+        }
+    },
+    block_sizes);
+#endif
+
+static Registration setLowerBoundLarge("Set::lower_bound",
+                                       set_lower_bound_large, large_sizes);
+static Registration btreeSetLowerBoundLarge(
+    "BTreeSet::lower_bound", btree_set_lower_bound_large, large_sizes);
+static Registration sortedFrozenSetLowerBound(
+    "FrozenSet::lower_bound (sorted)", sorted_frozen_set_lower_bound,
+    large_sizes);
+static Registration frozenSetLowerBound("Set::freeze()->lower_bound",
+                                        frozen_set_lower_bound, large_sizes);
+
+static Registration concurrentSetContains("ConcurrentSet::contains (4r+1w)",
+                                          concurrent_set_contains);
+static Registration sharedMutexSetContains(
+    "Set::contains, shared_mutex (4r+1w)", shared_mutex_set_contains);
+}  // namespace bench
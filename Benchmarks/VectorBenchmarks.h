@@ -0,0 +1,17 @@
+#pragma once
+#include "../2-Vector/Vector.h"
+#include "Benchmark.h"
+
+namespace bench {
+static Registration vectorPushBack("Vector::push_back", [](State& state) {
+    Vector<int> vec;
+
+    state.measure(state.size, [&] {
+        for (std::size_t i = 0; i < state.size; ++i) {
+            vec.push_back(static_cast<int>(i));
+        }
+    });
+
+    do_not_optimize(vec.data());
+});
+}  // namespace bench
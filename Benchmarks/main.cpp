@@ -0,0 +1,120 @@
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string_view>
+
+#include "Benchmark.h"
+
+#include "ForwardListBenchmarks.h"
+#include "HeapBenchmarks.h"
+#include "ListBenchmarks.h"
+#include "SetBenchmarks.h"
+#include "VectorBenchmarks.h"
+
+// Every allocation in the process goes through here,
+// which is how the benchmarks report allocations and bytes per operation.
+// The malloc and free calls stay out of line: inlined into a replaced
+// operator delete, GCC would pair the free with a `new` and warn.
+namespace {
+[[gnu::noinline]] auto counted_allocate(std::size_t size,
+                                        std::size_t alignment) -> void* {
+    ++bench::allocation_count;
+    bench::allocated_bytes += size;
+
+    void* ptr = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        ptr = std::malloc(size);
+    } else {
+        // Over-aligned types, like the cache line aligned B-tree nodes
+        std::size_t padded = (size + alignment - 1) / alignment * alignment;
+        ptr = std::aligned_alloc(alignment, padded);
+    }
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+[[gnu::noinline]] auto counted_free(void* ptr) noexcept -> void {
+    std::free(ptr);
+}
+}  // namespace
+
+auto operator new(std::size_t size) -> void* {
+    return counted_allocate(size, alignof(std::max_align_t));
+}
+
+auto operator new[](std::size_t size) -> void* {
+    return counted_allocate(size, alignof(std::max_align_t));
+}
+
+auto operator new(std::size_t size, std::align_val_t align) -> void* {
+    return counted_allocate(size, static_cast<std::size_t>(align));
+}
+
+auto operator new[](std::size_t size, std::align_val_t align) -> void* {
+    return counted_allocate(size, static_cast<std::size_t>(align));
+}
+
+auto operator delete(void* ptr) noexcept -> void {
+    counted_free(ptr);
+}
+
+auto operator delete[](void* ptr) noexcept -> void {
+    counted_free(ptr);
+}
+
+auto operator delete(void* ptr, std::size_t /*size*/) noexcept -> void {
+    counted_free(ptr);
+}
+
+auto operator delete[](void* ptr, std::size_t /*size*/) noexcept -> void {
+    counted_free(ptr);
+}
+
+auto operator delete(void* ptr, std::align_val_t /*align*/) noexcept -> void {
+    counted_free(ptr);
+}
+
+auto operator delete[](void* ptr, std::align_val_t /*align*/) noexcept
+    -> void {
+    counted_free(ptr);
+}
+
+auto operator delete(void* ptr,
+                     std::size_t /*size*/,
+                     std::align_val_t /*align*/) noexcept -> void {
+    counted_free(ptr);
+}
+
+auto operator delete[](void* ptr,
+                       std::size_t /*size*/,
+                       std::align_val_t /*align*/) noexcept -> void {
+    counted_free(ptr);
+}
+
+// Usage: benchmarks [name filter] [--json results.json]
+auto main(int argc, char** argv) -> int {
+    std::string_view filter;
+    const char* json_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    auto results = bench::run(filter);
+
+    if (json_path != nullptr) {
+        std::ofstream out(json_path);
+        bench::write_json(out, results);
+        if (!out) {
+            std::cerr << "couldn't write " << json_path << '\n';
+            return 1;
+        }
+    }
+}
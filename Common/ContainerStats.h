@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// Counters every container can report through, for telling how much work
+// an operation does beyond how long it takes.
+//
+// Allocations are counted by CountingAllocator, which any container that
+// takes an allocator can be given. The work counters, like rotations and
+// sift steps, are only bumped when CONTAINER_STATS is defined; otherwise
+// their hooks compile to nothing.
+//
+// A CountingAllocator made with a Stats of its own counts into it, and so
+// do the rotations of a Set built on it. Read them back through the
+// container's get_allocator().counted(). Copies of the allocator may count
+// from several threads at once, like the workers of the parallel set
+// algebra or the writers of a ConcurrentSet, so those counts are bumped
+// atomically; read them once that work is done.
+//
+// Everything else, sift steps included, goes into this thread's counters,
+// which only this thread ever bumps. A block may still be freed on another
+// thread than the one that allocated it, say by a ConcurrentSet writer or
+// after a container was handed to a worker, so a thread's live blocks can
+// go below zero. Only total(), the sum over all threads, counts them all.
+namespace container_stats {
+
+struct Stats {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytes = 0;  // allocated in total, freed or not
+    // Blocks allocated and not yet freed, for node containers one per node
+    std::ptrdiff_t live_blocks = 0;
+    std::ptrdiff_t peak_live_blocks = 0;
+
+    std::size_t rotations = 0;   // by the AVL Set
+    std::size_t sift_steps = 0;  // by the heap functions, one per swap
+};
+
+namespace detail {
+// The counters of every thread that has counted anything, so total() can
+// add them up. Those of the threads that are gone are kept in `exited`.
+struct Threads {
+    std::mutex mutex;
+    std::vector<const Stats*> running;
+    Stats exited;
+};
+
+inline auto threads() -> Threads& {
+    static Threads threads;
+    return threads;
+}
+
+template <typename T>
+auto load(const T& counter) -> T {
+    return std::atomic_ref(const_cast<T&>(counter))
+        .load(std::memory_order_relaxed);
+}
+
+inline auto add_to(Stats& sum, const Stats& stats) -> void {
+    sum.allocations += load(stats.allocations);
+    sum.deallocations += load(stats.deallocations);
+    sum.bytes += load(stats.bytes);
+    sum.live_blocks += load(stats.live_blocks);
+    sum.rotations += load(stats.rotations);
+    sum.sift_steps += load(stats.sift_steps);
+}
+
+struct ThreadStats {
+    Stats stats;
+
+    ThreadStats() {
+        std::lock_guard lock(threads().mutex);
+        threads().running.push_back(&stats);
+    }
+
+    ~ThreadStats() {
+        std::lock_guard lock(threads().mutex);
+        add_to(threads().exited, stats);
+        std::erase(threads().running, &stats);
+    }
+};
+
+inline thread_local ThreadStats this_thread;
+
+// This thread's own counters, which total() may be reading meanwhile.
+// Only this thread writes them, so a load and a store will do. The peak
+// isn't part of the total and needs neither.
+template <typename T>
+auto bump(T& counter, std::type_identity_t<T> n) -> T {
+    std::atomic_ref own(counter);
+    T value = own.load(std::memory_order_relaxed) + n;
+    own.store(value, std::memory_order_relaxed);
+    return value;
+}
+
+// Stats other threads may be counting into at the same time
+template <typename T>
+auto add_shared(T& counter, std::type_identity_t<T> n) -> T {
+    std::atomic_ref shared(counter);
+    return shared.fetch_add(n, std::memory_order_relaxed) + n;
+}
+
+template <typename T>
+auto raise_shared(T& counter, std::type_identity_t<T> value) -> void {
+    std::atomic_ref peak(counter);
+    T seen = peak.load(std::memory_order_relaxed);
+    while (seen < value && !peak.compare_exchange_weak(
+                               seen, value, std::memory_order_relaxed)) {
+    }
+}
+}  // namespace detail
+
+inline auto thread_stats() -> Stats& {
+    return detail::this_thread.stats;
+}
+
+// The counters of this thread so far
+inline auto current() -> const Stats& {
+    return thread_stats();
+}
+
+// The counters of every thread so far, added up, except the peak:
+// the peaks of different threads don't add up, so it's left at zero
+inline auto total() -> Stats {
+    detail::Threads& threads = detail::threads();
+    std::lock_guard lock(threads.mutex);
+    Stats sum = threads.exited;
+    for (const Stats* stats : threads.running) {
+        detail::add_to(sum, *stats);
+    }
+    return sum;
+}
+
+// Starts the peak over from what this thread has live now,
+// so it tells the most a stretch of work had allocated at once
+inline auto reset_peak() -> void {
+    Stats& stats = thread_stats();
+    stats.peak_live_blocks = stats.live_blocks;
+}
+
+inline auto count_sift_step() -> void {
+#if defined(CONTAINER_STATS)
+    detail::bump(thread_stats().sift_steps, 1);
+#endif
+}
+
+// Allocates through `Alloc` and counts every allocation into `stats`,
+// which is shared by all copies and rebindings of the allocator.
+// Without one, it counts into this thread's counters.
+template <typename T, typename Alloc = std::allocator<T>>
+class CountingAllocator {
+  public:
+    using value_type = T;
+
+    CountingAllocator() = default;
+    explicit CountingAllocator(const Alloc& alloc) : alloc(alloc) {}
+    explicit CountingAllocator(Stats& stats, const Alloc& alloc = Alloc())
+        : stats(&stats), alloc(alloc) {}
+    template <typename U, typename A>
+    CountingAllocator(const CountingAllocator<U, A>& other)
+        : stats(other.stats), alloc(other.alloc) {}
+
+    template <typename U>
+    struct rebind {
+        using other = CountingAllocator<
+            U,
+            typename std::allocator_traits<Alloc>::template rebind_alloc<U>>;
+    };
+
+    auto allocate(std::size_t n) -> T* {
+        T* ptr = std::allocator_traits<Alloc>::allocate(alloc, n);
+        if (stats == nullptr) {
+            Stats& own = thread_stats();
+            detail::bump(own.allocations, 1);
+            detail::bump(own.bytes, n * sizeof(T));
+            std::ptrdiff_t live = detail::bump(own.live_blocks, 1);
+            own.peak_live_blocks = std::max(own.peak_live_blocks, live);
+        } else {
+            detail::add_shared(stats->allocations, 1);
+            detail::add_shared(stats->bytes, n * sizeof(T));
+            std::ptrdiff_t live = detail::add_shared(stats->live_blocks, 1);
+            detail::raise_shared(stats->peak_live_blocks, live);
+        }
+        return ptr;
+    }
+
+    auto deallocate(T* ptr, std::size_t n) -> void {
+        // some containers free the null pointer they start out with
+        if (ptr == nullptr) {
+            return;
+        }
+        std::allocator_traits<Alloc>::deallocate(alloc, ptr, n);
+        if (stats == nullptr) {
+            Stats& own = thread_stats();
+            detail::bump(own.deallocations, 1);
+            detail::bump(own.live_blocks, -1);
+        } else {
+            detail::add_shared(stats->deallocations, 1);
+            detail::add_shared(stats->live_blocks, -1);
+        }
+    }
+
+    auto counted() const -> Stats& {
+        return stats != nullptr ? *stats : thread_stats();
+    }
+
+    template <typename U, typename A>
+    auto operator==(const CountingAllocator<U, A>& other) const -> bool {
+        return stats == other.stats && alloc == other.alloc;
+    }
+
+  private:
+    template <typename U, typename A>
+    friend class CountingAllocator;
+
+    Stats* stats = nullptr;
+    [[no_unique_address]]
+    Alloc alloc;
+};
+
+// Counts a rotation into the stats of the container's allocator,
+// if it has any of its own, and into this thread's otherwise
+template <typename Alloc>
+auto count_rotation([[maybe_unused]] const Alloc& alloc) -> void {
+#if defined(CONTAINER_STATS)
+    detail::bump(thread_stats().rotations, 1);
+#endif
+}
+
+template <typename T, typename A>
+auto count_rotation([[maybe_unused]] const CountingAllocator<T, A>& alloc)
+    -> void {
+#if defined(CONTAINER_STATS)
+    Stats& into = alloc.counted();
+    if (&into == &thread_stats()) {
+        detail::bump(into.rotations, 1);
+    } else {
+        detail::add_shared(into.rotations, 1);
+    }
+#endif
+}
+
+}  // namespace container_stats
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Allocators for containers that allocate one small node at a time.
+// Each is a handle to a memory resource that has to outlive every
+// container using it; copies and rebindings share the resource.
+//
+//     NodePool pool;
+//     List<int, PoolAllocator<int>> list{PoolAllocator<int>(pool)};
+
+// Hands out blocks of one size, carved from chunks of many blocks at once,
+// and reuses freed blocks before carving new ones.
+// The block size is set by the first allocation; blocks of any other size,
+// or arrays, go straight to operator new.
+class NodePool {
+  public:
+    explicit NodePool(std::size_t blocks_per_chunk = 1024)
+        : blocks_per_chunk(std::max<std::size_t>(blocks_per_chunk, 1)) {}
+    NodePool(const NodePool&) = delete;
+    auto operator=(const NodePool&) -> NodePool& = delete;
+    ~NodePool() {
+        while (chunks != nullptr) {
+            Chunk* next = chunks->next;
+            ::operator delete(chunks);
+            chunks = next;
+        }
+    }
+
+    auto allocate(std::size_t bytes, std::size_t alignment) -> void* {
+        if (block_size == 0 && alignment <= alignof(std::max_align_t)) {
+            block_size = round_up(std::max(bytes, sizeof(FreeBlock)),
+                                  alignof(std::max_align_t));
+            requested_size = bytes;
+        }
+        if (bytes != requested_size || alignment > alignof(std::max_align_t)) {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+
+        if (free_blocks == nullptr) {
+            grow();
+        }
+        FreeBlock* block = free_blocks;
+        free_blocks = block->next;
+        return block;
+    }
+
+    auto deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+        -> void {
+        if (bytes != requested_size || alignment > alignof(std::max_align_t)) {
+            ::operator delete(ptr, std::align_val_t(alignment));
+            return;
+        }
+
+        free_blocks = ::new (ptr) FreeBlock{free_blocks};
+    }
+
+    auto chunk_count() const -> std::size_t {
+        std::size_t count = 0;
+        for (const Chunk* chunk = chunks; chunk != nullptr;
+             chunk = chunk->next) {
+            count++;
+        }
+        return count;
+    }
+
+  private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+    };
+
+    static constexpr auto round_up(std::size_t n, std::size_t to)
+        -> std::size_t {
+        return (n + to - 1) / to * to;
+    }
+
+    // Threads the blocks of a new chunk onto the free list in address order,
+    // so a container filled in one go walks its nodes front to back
+    auto grow() -> void {
+        void* memory = ::operator new(sizeof(Chunk) +
+                                      blocks_per_chunk * block_size);
+        chunks = ::new (memory) Chunk{chunks};
+
+        auto* first = reinterpret_cast<std::byte*>(chunks + 1);
+        for (std::size_t i = blocks_per_chunk; i-- > 0;) {
+            free_blocks = ::new (first + i * block_size) FreeBlock{free_blocks};
+        }
+    }
+
+    std::size_t blocks_per_chunk;
+    std::size_t block_size = 0;
+    std::size_t requested_size = 0;
+    FreeBlock* free_blocks = nullptr;
+    Chunk* chunks = nullptr;
+};
+
+// Bumps a pointer through big chunks and never frees anything on its own:
+// all of it goes back at once when the arena is destroyed or released.
+class Arena {
+  public:
+    explicit Arena(std::size_t chunk_size = 64 * 1024)
+        : chunk_size(chunk_size) {}
+    Arena(const Arena&) = delete;
+    auto operator=(const Arena&) -> Arena& = delete;
+    ~Arena() {
+        release();
+    }
+
+    auto allocate(std::size_t bytes, std::size_t alignment) -> void* {
+        void* ptr = next;
+        std::size_t space = end - next;
+        if (next == nullptr ||
+            std::align(alignment, bytes, ptr, space) == nullptr) {
+            grow(bytes + alignment);
+            ptr = next;
+            space = end - next;
+            std::align(alignment, bytes, ptr, space);
+        }
+
+        next = static_cast<std::byte*>(ptr) + bytes;
+        return ptr;
+    }
+
+    // Frees every chunk. Only for when nothing allocated here is in use.
+    auto release() -> void {
+        while (chunks != nullptr) {
+            Chunk* next = chunks->next;
+            ::operator delete(chunks);
+            chunks = next;
+        }
+        next = nullptr;
+        end = nullptr;
+    }
+
+  private:
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+    };
+
+    auto grow(std::size_t at_least) -> void {
+        std::size_t size = std::max(chunk_size, at_least);
+        void* memory = ::operator new(sizeof(Chunk) + size);
+        chunks = ::new (memory) Chunk{chunks};
+        next = reinterpret_cast<std::byte*>(chunks + 1);
+        end = next + size;
+    }
+
+    std::size_t chunk_size;
+    std::byte* next = nullptr;
+    std::byte* end = nullptr;
+    Chunk* chunks = nullptr;
+};
+
+template <typename T>
+class PoolAllocator {
+  public:
+    using value_type = T;
+
+    explicit PoolAllocator(NodePool& pool) : pool(&pool) {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool(other.pool) {}
+
+    auto allocate(std::size_t n) -> T* {
+        return static_cast<T*>(pool->allocate(n * sizeof(T), alignof(T)));
+    }
+    auto deallocate(T* ptr, std::size_t n) -> void {
+        pool->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    auto operator==(const PoolAllocator<U>& other) const -> bool {
+        return pool == other.pool;
+    }
+
+  private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    NodePool* pool;
+};
+
+template <typename T>
+class ArenaAllocator {
+  public:
+    using value_type = T;
+    // deallocate() does nothing, see monotonic_allocator below
+    using is_monotonic = std::true_type;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    auto allocate(std::size_t n) -> T* {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    auto deallocate(T* /*ptr*/, std::size_t /*n*/) -> void {}
+
+    template <typename U>
+    auto operator==(const ArenaAllocator<U>& other) const -> bool {
+        return arena == other.arena;
+    }
+
+  private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+};
+
+// An allocator that gives memory back only all at once, so a container
+// holding nothing that needs destroying can drop its nodes without
+// visiting them
+template <typename Alloc>
+concept monotonic_allocator = Alloc::is_monotonic::value;